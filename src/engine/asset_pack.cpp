@@ -0,0 +1,282 @@
+#include "asset_pack.hpp"
+
+#include "raylib.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ASSET_PACK_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char PACK_MAGIC[4] = { 'C', 'P', 'A', 'K' };
+static const unsigned int PACK_VERSION = 1;
+static const size_t PACK_HEADER_SIZE = 24;
+
+static unsigned int read_u32(const unsigned char* ptr)
+{
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (unsigned int)ptr[i] << (i * 8);
+    return value;
+}
+
+static unsigned long long read_u64(const unsigned char* ptr)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; i++)
+        value |= (unsigned long long)ptr[i] << (i * 8);
+    return value;
+}
+
+static void put_u32(std::string* bytes, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+        bytes->push_back((char)((value >> (i * 8)) & 0xFF));
+}
+
+static void put_u64(std::string* bytes, unsigned long long value)
+{
+    for (int i = 0; i < 8; i++)
+        bytes->push_back((char)((value >> (i * 8)) & 0xFF));
+}
+
+//====================================================================
+
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+bool AssetPack::open(const char* file_name)
+{
+    close();
+
+#ifdef ASSET_PACK_MMAP
+    int fd = ::open(file_name, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+    base = (unsigned char*)mapping;
+    size = info.st_size;
+    is_mapped = true;
+#else
+    int data_size = 0;
+    base = LoadFileData(file_name, &data_size);
+    size = data_size;
+    is_mapped = false;
+
+    if (!base)
+        return false;
+#endif
+
+    if (!read_index()) {
+        TraceLog(LOG_WARNING, "Asset pack '%s' is broken", file_name);
+        close();
+        return false;
+    }
+
+    TraceLog(LOG_INFO, "Opened asset pack '%s' with %d entries", file_name, (int)entries.size());
+    path = file_name;
+    return true;
+}
+
+void AssetPack::close()
+{
+    if (!base)
+        return;
+
+#ifdef ASSET_PACK_MMAP
+    if (is_mapped)
+        munmap(base, size);
+#endif
+    if (!is_mapped)
+        UnloadFileData(base);
+
+    base = nullptr;
+    size = 0;
+    entries.clear();
+    path.clear();
+}
+
+bool AssetPack::read_index()
+{
+    if (size < PACK_HEADER_SIZE || memcmp(base, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0)
+        return false;
+
+    if (read_u32(base + 4) > PACK_VERSION)
+        return false;
+
+    unsigned int count = read_u32(base + 8);
+    unsigned long long pos = read_u64(base + 16);
+
+    for (unsigned int i = 0; i < count; i++) {
+        if (pos + 4 > size)
+            return false;
+
+        unsigned int name_length = read_u32(base + pos);
+        pos += 4;
+
+        if (pos + name_length + 28 > size)
+            return false;
+
+        std::string name((const char*)base + pos, name_length);
+        pos += name_length;
+
+        Entry entry;
+        entry.offset = read_u64(base + pos);
+        entry.size = read_u64(base + pos + 8);
+        entry.original_size = read_u64(base + pos + 16);
+        entry.flags = read_u32(base + pos + 24);
+        pos += 28;
+
+        if (entry.offset > size || entry.size > size - entry.offset)
+            return false;
+
+        entries[name] = entry;
+    }
+
+    return true;
+}
+
+bool AssetPack::contains(const std::string& name) const
+{
+    return entries.count(name) > 0;
+}
+
+void AssetPack::get_names(std::vector<std::string>* names) const
+{
+    for (auto& [name, entry] : entries)
+        names->push_back(name);
+}
+
+bool AssetPack::get(const std::string& name, AssetView* view, std::vector<unsigned char>* storage) const
+{
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return false;
+
+    const Entry& entry = it->second;
+
+    if (!(entry.flags & ENTRY_COMPRESSED)) {
+        view->data = base + entry.offset;
+        view->size = entry.size;
+        return true;
+    }
+
+    int inflated_size = 0;
+    unsigned char* inflated = DecompressData(base + entry.offset, entry.size, &inflated_size);
+    if (!inflated || (unsigned long long)inflated_size != entry.original_size) {
+        MemFree(inflated);
+        TraceLog(LOG_WARNING, "Could not decompress asset '%s'", name.c_str());
+        return false;
+    }
+
+    storage->assign(inflated, inflated + inflated_size);
+    MemFree(inflated);
+
+    view->data = storage->data();
+    view->size = storage->size();
+    return true;
+}
+
+//====================================================================
+// Building packs
+
+bool write_asset_pack(const char* file_name, const std::vector<PackSource>& sources, bool compress)
+{
+    std::string bytes(PACK_HEADER_SIZE, '\0');
+    std::string index;
+
+    for (const PackSource& source : sources) {
+        int data_size = 0;
+        unsigned char* data = LoadFileData(source.path.c_str(), &data_size);
+        if (!data) {
+            TraceLog(LOG_WARNING, "Could not read '%s'", source.path.c_str());
+            return false;
+        }
+
+        unsigned int flags = 0;
+        const unsigned char* stored = data;
+        int stored_size = data_size;
+
+        unsigned char* compressed = nullptr;
+        if (compress && data_size > 0) {
+            int compressed_size = 0;
+            compressed = CompressData(data, data_size, &compressed_size);
+
+            if (compressed && compressed_size < data_size) {
+                flags |= AssetPack::ENTRY_COMPRESSED;
+                stored = compressed;
+                stored_size = compressed_size;
+            }
+        }
+
+        // Keep every entry aligned so it can be used straight out of the mapping
+        bytes.resize((bytes.size() + ASSET_ALIGNMENT - 1) / ASSET_ALIGNMENT * ASSET_ALIGNMENT, '\0');
+        unsigned long long offset = bytes.size();
+        bytes.append((const char*)stored, stored_size);
+
+        put_u32(&index, source.name.size());
+        index.append(source.name);
+        put_u64(&index, offset);
+        put_u64(&index, stored_size);
+        put_u64(&index, data_size);
+        put_u32(&index, flags);
+
+        TraceLog(LOG_INFO, "    %s - %d bytes%s", source.name.c_str(), stored_size, (flags & AssetPack::ENTRY_COMPRESSED) ? " (compressed)" : "");
+
+        MemFree(compressed);
+        UnloadFileData(data);
+    }
+
+    unsigned long long index_offset = bytes.size();
+    bytes.append(index);
+
+    std::string header;
+    header.append(PACK_MAGIC, sizeof(PACK_MAGIC));
+    put_u32(&header, PACK_VERSION);
+    put_u32(&header, sources.size());
+    put_u32(&header, 0);
+    put_u64(&header, index_offset);
+    bytes.replace(0, PACK_HEADER_SIZE, header);
+
+    std::string temp_name = std::string(file_name) + ".tmp";
+    FILE* file = fopen(temp_name.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool success = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    success &= fclose(file) == 0;
+
+    // The pack already on disk is left alone if the new one couldn't be written
+    if (!success) {
+        std::remove(temp_name.c_str());
+        return false;
+    }
+
+    if (std::rename(temp_name.c_str(), file_name) != 0) {
+        std::remove(file_name);
+        if (std::rename(temp_name.c_str(), file_name) != 0) {
+            std::remove(temp_name.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
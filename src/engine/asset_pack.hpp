@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//====================================================================
+// Read only asset pack
+//
+//   "CPAK", u32 version, u32 entry count, u32 flags, u64 index offset
+//   entry data, each entry aligned to ASSET_ALIGNMENT
+//   index, per entry: u32 name length, name, u64 offset, u64 size,
+//                     u64 original size, u32 flags
+//
+// The whole pack is mapped into memory with one mmap where available (read
+// in one go elsewhere). Uncompressed entries are used in place, compressed
+// ones are inflated on request.
+
+static const int ASSET_ALIGNMENT = 16;
+
+struct AssetView {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
+
+struct PackSource {
+    std::string name;
+    std::string path;
+};
+
+class AssetPack {
+public:
+    enum EntryFlags {
+        ENTRY_COMPRESSED = 1,
+    };
+
+    AssetPack() { }
+    ~AssetPack();
+
+    bool open(const char* file_name);
+    void close();
+
+    inline bool is_open() const { return base != nullptr; }
+    inline int get_entry_count() const { return entries.size(); }
+    inline const std::string& get_path() const { return path; }
+    bool contains(const std::string& name) const;
+    void get_names(std::vector<std::string>* names) const;
+
+    // Uncompressed entries point into the pack, compressed ones are inflated into storage.
+    // Views stay valid until the pack is closed (or storage changes). Safe from any thread
+    // while the pack stays open
+    bool get(const std::string& name, AssetView* view, std::vector<unsigned char>* storage) const;
+
+private:
+    struct Entry {
+        unsigned long long offset;
+        unsigned long long size;
+        unsigned long long original_size;
+        unsigned int flags;
+    };
+
+    bool read_index();
+
+private:
+    unsigned char* base = nullptr;
+    size_t size = 0;
+    bool is_mapped = false;
+    std::string path;
+
+    std::unordered_map<std::string, Entry> entries;
+};
+
+// Entries are only stored compressed when compress is set and it makes them smaller
+bool write_asset_pack(const char* file_name, const std::vector<PackSource>& sources, bool compress);
@@ -0,0 +1,31 @@
+#include "commands.hpp"
+
+#include <algorithm>
+
+static thread_local int current_source = -1;
+
+//====================================================================
+
+void WorldCommands::record(WorldCommandType type, Entity* entity, Vector2 pos)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    commands.push_back({ type, current_source, entity, pos });
+}
+
+void WorldCommands::sort()
+{
+    std::stable_sort(
+        commands.begin(),
+        commands.end(),
+        [](const WorldCommand& a, const WorldCommand& b) { return a.source < b.source; });
+}
+
+void WorldCommands::clear()
+{
+    commands.clear();
+}
+
+void WorldCommands::set_source(int source)
+{
+    current_source = source;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "raylib.h"
+#include <mutex>
+#include <vector>
+
+//====================================================================
+// Deferred world changes
+//
+// While the world is iterating over its entities, spawns, destroys and moves
+// are recorded here and applied together once the phase ends.
+
+enum class WorldCommandType {
+    AddActor,
+    AddSolid,
+    DestroyActor,
+    DestroySolid,
+    Move,
+};
+
+struct WorldCommand {
+    WorldCommandType type;
+    int source;
+    class Entity* entity;
+    Vector2 pos;
+};
+
+class WorldCommands {
+public:
+    // Safe to call from several threads at once
+    void record(WorldCommandType type, class Entity* entity, Vector2 pos = { 0 });
+
+    // Sort recorded commands by source, keeping the recorded order within each source
+    void sort();
+    void clear();
+
+    inline bool empty() { return commands.empty(); }
+    inline std::vector<WorldCommand>* get_commands() { return &commands; }
+
+    // Tag commands recorded by the current thread, e.g. with the index of the actor being updated
+    static void set_source(int source);
+
+private:
+    std::mutex mutex;
+    std::vector<WorldCommand> commands;
+};
@@ -2,16 +2,18 @@
 
 #include "../defs.hpp"
 #include "../game/player.hpp"
+#include "level_catalog.hpp"
+#include "raygui.h"
 #include "raylib.h"
 #include "tools.hpp"
 #include "ui.hpp"
 #include "world.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <magic_enum.hpp>
-
-#define RAYGUI_IMPLEMENTATION
-#include "raygui.h"
+#include <unordered_set>
 
 //====================================================================
 
@@ -20,25 +22,35 @@ Debugger::Debugger() { }
 //====================================================================
 // Access functions
 
-void Debugger::add_message(const char* text, int log)
+static int log_channel(int log)
 {
     switch (log) {
     case 0:
-        messages_0.push_back(std::string(text));
-        break;
+        return 0;
     case 1:
-        messages_1.push_back(std::string(text));
-        break;
+        return 1;
     default:
-        messages_2.push_back(std::string(text));
+        return 2;
     }
 }
 
+void Debugger::add_message(const char* text, int log)
+{
+    messages[log_channel(log)].push(0, "%s", text);
+}
+
+void Debugger::add_message_v(int log, const char* format, va_list args)
+{
+    messages[log_channel(log)].push_v(0, format, args);
+}
+
 //====================================================================
 // Updating and rendering
 
 void Debugger::update(World* world)
 {
+    level_thumbnails.update();
+
     if (IsKeyPressed(KEY_F1))
         is_log_enabled = !is_log_enabled;
 
@@ -63,9 +75,56 @@ void Debugger::update(World* world)
     if (IsKeyDown(KEY_PERIOD))
         world->camera.zoom_target = fmax(world->camera.zoom_target - 0.2, 0.2);
 
+    // Inspector picking
+    if (
+        is_debug_menu
+        && current_menu == DebugMenu::Inspector
+        && !is_level_editor_enabled
+        && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)
+        && !CheckCollisionPointRec(GetMousePosition(), menu_rect) //
+    ) {
+        pick_entity(world);
+    }
+
     update_level_editor(world);
 }
 
+// Sample plotted properties, cost is bounded by MAX_PLOTS
+void Debugger::fixed_update(World* world)
+{
+    if (plot_count == 0)
+        return;
+
+    for (int i = 0; i < plot_count; i++) {
+        PropertyPlot* plot = &plots[i];
+
+        plot_properties.clear();
+        plot->owner->get_properties(&plot_properties);
+
+        float values[2] = { 0.0f, 0.0f };
+
+        for (DebugProperty& property : plot_properties) {
+            if (strcmp(property.name, plot->name) != 0)
+                continue;
+
+            if (std::holds_alternative<int*>(property.property_type))
+                values[0] = *get<int*>(property.property_type);
+            else if (std::holds_alternative<float*>(property.property_type))
+                values[0] = *get<float*>(property.property_type);
+            else if (std::holds_alternative<Vector2*>(property.property_type)) {
+                values[0] = get<Vector2*>(property.property_type)->x;
+                values[1] = get<Vector2*>(property.property_type)->y;
+            }
+            break;
+        }
+
+        plot->samples[0][plot->head] = values[0];
+        plot->samples[1][plot->head] = values[1];
+        plot->head = (plot->head + 1) % PropertyPlot::SAMPLES;
+        plot->count = std::min(plot->count + 1, PropertyPlot::SAMPLES);
+    }
+}
+
 void Debugger::render_2d(World* world)
 {
     render_level_editor(world);
@@ -76,25 +135,30 @@ void Debugger::render(World* world)
     if (is_log_enabled) {
 
         auto data = world->get_physics_data();
-        const char* elapsed = TextFormat("elapsed: %f", data->elapsed);
-        const char* fps = TextFormat("FPS: %d", GetFPS());
-        const char* timestep = TextFormat("Timestep: %f", data->timestep);
-        const char* accumulator = TextFormat("Accumulator: %f", data->accumulator);
-
-        std::vector<std::string> temp {
-            std::string(elapsed),
-            std::string(fps),
-            std::string(timestep),
-            std::string(accumulator)
-        };
+        char stats[LOG_HEADER_LINES][LogRing::slot_size];
+        snprintf(stats[0], LogRing::slot_size, "elapsed: %f", data->elapsed);
+        snprintf(stats[1], LogRing::slot_size, "FPS: %d", GetFPS());
+        snprintf(stats[2], LogRing::slot_size, "Timestep: %f", data->timestep);
+        snprintf(stats[3], LogRing::slot_size, "Accumulator: %f", data->accumulator);
+
+        for (int x = 0; x < LOG_HEADER_LINES; x++) {
+            if (strcmp(stats[x], log_stats[x]) != 0) {
+                strcpy(log_stats[x], stats[x]);
+                log_cache[0].dirty = true;
+            }
+        }
 
-        messages_0.insert(messages_0.begin(), temp.begin(), temp.end());
+        memcpy(log_lines, log_stats, sizeof(log_stats));
 
-        render_log(&messages_0, 0);
-        render_log(&messages_1, 1);
-        render_log(&messages_2, 2);
+        render_log(0, LOG_HEADER_LINES);
+        render_log(1, 0);
+        render_log(2, 0);
     }
 
+    // Messages only live for a frame
+    else
+        discard_log();
+
     if (is_debug_menu)
         render_debug_menu(world);
 }
@@ -102,14 +166,49 @@ void Debugger::render(World* world)
 //====================================================================
 // Logging
 
-void Debugger::render_log(std::vector<std::string>* messages, int index)
+// Drains a channel into log_lines after the first header_count lines, then draws it.
+// The box is kept in a render texture and only redrawn when lines are drained or the stats change
+void Debugger::render_log(int index, int header_count)
 {
-    if (messages->empty())
+    int line_count = header_count;
+
+    while (line_count < LOG_HEADER_LINES + LogRing::capacity) {
+        char* line = log_lines[line_count];
+        bool popped = messages[index].pop([line](int, const char* text) {
+            strncpy(line, text, LogRing::slot_size);
+        });
+
+        if (!popped)
+            break;
+
+        line_count += 1;
+    }
+
+    LogCache* cache = &log_cache[index];
+
+    // Anything drained replaces last frame's lines
+    if (line_count > header_count)
+        cache->dirty = true;
+
+    int dropped = messages[index].take_dropped();
+    if (dropped > 0 && line_count < LOG_HEADER_LINES + LogRing::capacity) {
+        snprintf(log_lines[line_count], LogRing::slot_size, "(%d messages dropped)", dropped);
+        line_count += 1;
+        cache->dirty = true;
+    }
+
+    if (line_count != cache->line_count)
+        cache->dirty = true;
+
+    if (line_count == 0) {
+        cache->line_count = 0;
+        cache->dirty = false;
         return;
+    }
 
     const int spacing = 20;
     const int box_width = 500;
-    int box_height = spacing * messages->size() + 20;
+    int box_height = spacing * line_count + 20;
 
     int start_x = 20 + (box_width + spacing) * index;
     const int start_y = 20;
@@ -117,31 +216,75 @@ void Debugger::render_log(std::vector<std::string>* messages, int index)
     int box_start_x = start_x - 10;
     const int box_start_y = start_y - 10;
 
-    Color color;
-    switch (index) {
-    case 0:
-        color = SKYBLUE;
-        break;
-    case 1:
-        color = RED;
-        break;
-    default:
-        color = GREEN;
+    // Only ever grows, the box uses the top of it. The line count changes nearly every frame
+    if (cache->texture.id == 0 || cache->texture.texture.height < box_height) {
+        if (cache->texture.id != 0)
+            UnloadRenderTexture(cache->texture);
+
+        cache->texture = LoadRenderTexture(box_width, box_height);
+        cache->dirty = true;
     }
 
-    DrawRectangle(box_start_x, box_start_y, box_width, box_height, Fade(color, 0.6f));
-    DrawRectangleLines(box_start_x, box_start_y, box_width, box_height, color);
+    if (cache->dirty) {
+        cache->dirty = false;
+        cache->line_count = line_count;
+
+        Color color;
+        switch (index) {
+        case 0:
+            color = SKYBLUE;
+            break;
+        case 1:
+            color = RED;
+            break;
+        default:
+            color = GREEN;
+        }
 
-    for (int x = 0; x < messages->size(); x++) {
-        DrawText(
-            (*messages)[x].c_str(),
-            start_x,
-            start_y + spacing * x,
-            20,
-            BLACK);
-    };
+        BeginTextureMode(cache->texture);
+        ClearBackground(BLANK);
+
+        DrawRectangle(0, 0, box_width, box_height, Fade(color, 0.6f));
+        DrawRectangleLines(0, 0, box_width, box_height, color);
+
+        for (int x = 0; x < line_count; x++) {
+            DrawText(
+                log_lines[x],
+                start_x - box_start_x,
+                start_y - box_start_y + spacing * x,
+                20,
+                BLACK);
+        };
+
+        EndTextureMode();
+    }
 
-    messages->clear();
+    // Render textures are stored upside down, so the top of the box is at the bottom of the texture
+    int texture_height = cache->texture.texture.height;
+    DrawTextureRec(
+        cache->texture.texture,
+        { 0, (float)(texture_height - box_height), (float)box_width, (float)-box_height },
+        { (float)box_start_x, (float)box_start_y },
+        WHITE);
+}
+
+void Debugger::unload()
+{
+    level_thumbnails.stop();
+
+    for (LogCache& cache : log_cache) {
+        if (cache.texture.id != 0)
+            UnloadRenderTexture(cache.texture);
+        cache = LogCache();
+    }
+}
+
+void Debugger::discard_log()
+{
+    for (LogRing& ring : messages) {
+        while (ring.pop([](int, const char*) {})) { }
+        ring.take_dropped();
+    }
 }
 
 //====================================================================
@@ -178,6 +321,9 @@ void Debugger::render_debug_menu(World* world)
     case DebugMenu::Player:
         render_player_menu(world);
         return;
+    case DebugMenu::Plots:
+        render_plot_menu(world);
+        return;
     case DebugMenu::Main:
         break;
     }
@@ -202,6 +348,10 @@ void Debugger::render_debug_menu(World* world)
         build_player_menu(world);
         current_menu = DebugMenu::Player;
     }
+
+    if (GuiButton({ menu_rect.x + 24, menu_rect.y + 312, 240, 48 }, "Plots")) {
+        current_menu = DebugMenu::Plots;
+    }
 }
 
 void Debugger::render_level_menu(World* world)
@@ -210,29 +360,55 @@ void Debugger::render_level_menu(World* world)
         current_menu = DebugMenu::Main;
     }
 
-    GuiListView(
-        { menu_rect.x + 8, menu_rect.y + 32, 274, 104 },
-        levels_name_list.c_str(),
+    LevelCatalog* catalog = world->get_level_catalog();
+    const std::vector<LevelInfo>& levels = catalog->get_levels();
+
+    // Levels were added, removed or changed on disk
+    if (catalog->get_generation() != level_menu_generation)
+        build_level_menu(world);
+
+    GuiLevelListView(
+        { menu_rect.x + 8, menu_rect.y + 32, 274, 120 },
+        levels,
+        &level_thumbnails,
         &level_list_scroll_index,
         &level_list_active);
 
-    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 144, 192, 32 }, "Load")) {
+    // Selected level details
+    if (level_list_active != level_info_index) {
+        level_info_index = level_list_active;
+
+        if (level_list_active < 0 || level_list_active >= levels.size())
+            level_info_text[0] = '\0';
+        else if (!levels[level_list_active].valid)
+            snprintf(level_info_text, sizeof(level_info_text), "Unreadable level");
+        else {
+            const LevelInfo& level = levels[level_list_active];
+            snprintf(
+                level_info_text, sizeof(level_info_text), "%d solids, %d actors - %dx%d",
+                level.solids, level.actors, (int)level.bounds.width, (int)level.bounds.height);
+        }
+    }
+
+    GuiLabel({ menu_rect.x + 8, menu_rect.y + 156, 274, 24 }, level_info_text);
+
+    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 184, 192, 32 }, "Load")) {
         if (level_list_active >= 0 && level_list_active < levels.size()) {
-            world->load_level(levels[level_list_active]);
+            world->load_level(levels[level_list_active].file_name.c_str());
         }
     }
 
-    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 192, 192, 32 }, "Refresh")) {
-        build_level_menu(world);
+    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 224, 192, 32 }, "Refresh")) {
+        catalog->rescan();
     }
 
-    GuiLine({ menu_rect.x + 8, menu_rect.y + 232, 272, 16 }, NULL);
+    GuiLine({ menu_rect.x + 8, menu_rect.y + 260, 272, 16 }, NULL);
 
-    Rectangle text_box_rect = { menu_rect.x + 8, menu_rect.y + 256, 272, 48 };
+    Rectangle text_box_rect = { menu_rect.x + 8, menu_rect.y + 280, 272, 40 };
     bool editing = CheckCollisionPointRec(GetMousePosition(), text_box_rect);
 
     GuiTextBox(text_box_rect, level_menu_name, 128, editing);
-    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 312, 192, 32 }, "Save Level")) {
+    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 328, 192, 32 }, "Save Level")) {
         std::string name(level_menu_name);
 
         name.erase(
@@ -240,27 +416,29 @@ void Debugger::render_level_menu(World* world)
             name.end());
 
         if (!name.empty()) {
+            // The level list is rebuilt once the save has been written
             world->save_level(name.c_str());
-            build_level_menu(world);
         }
     }
 
-    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 360, 192, 32 }, "Clear Level")) {
+    if (GuiButton({ menu_rect.x + 48, menu_rect.y + 368, 192, 32 }, "Clear Level")) {
+        // Journal every removal so the cleared level survives a restart like any other edit
+        for (Solid* solid : *world->get_solids())
+            world->record_edit(to_tile_edit(solid, false));
+
         world->clear_level();
+        edit_history.clear();
     }
 }
 
 void Debugger::build_level_menu(World* world)
 {
-    levels = world->get_levels();
+    LevelCatalog* catalog = world->get_level_catalog();
+    level_menu_generation = catalog->get_generation();
+    level_info_index = -2;
 
-    levels_name_list.clear();
-    for (const char* level : levels) {
-        levels_name_list.append(";").append(level);
-    }
-
-    // Remove leading semi-colon
-    levels_name_list.erase(0, 1);
+    // Thumbnails are only made while the level menu is in use
+    level_thumbnails.start(world->get_assets());
 }
 
 void Debugger::render_inspector_menu(World* world)
@@ -270,25 +448,56 @@ void Debugger::render_inspector_menu(World* world)
         current_menu = DebugMenu::Main;
     }
 
+    // Removed entities are already gone from the list, new ones wait for the next rebuild
+    if (world->get_entity_generation() != inspector_generation && GetTime() - inspector_build_time >= INSPECTOR_REBUILD_INTERVAL)
+        build_inspector_menu(world);
+
     //----------------------------------------------
     // Top, entity selection area
 
-    GuiLabel({ menu_rect.x + 24, menu_rect.y + 32, 96, 24 }, "Entities");
+    Rectangle filter_rect = { menu_rect.x + 8, menu_rect.y + 32, 128, 24 };
+    bool editing = CheckCollisionPointRec(GetMousePosition(), filter_rect);
+    GuiTextBox(filter_rect, inspector_filter, 64, editing);
 
-    int inspector_list_active_previous = inspector_list_active;
+    if (strcmp(inspector_filter, inspector_applied_filter) != 0) {
+        strcpy(inspector_applied_filter, inspector_filter);
+        inspector_page = 0;
+        apply_inspector_filter();
+    }
 
-    if (debug_entities.empty()) {
-        GuiPanel({ menu_rect.x + 8, menu_rect.y + 64, 128, 128 }, NULL);
-    } else {
-        std::string entity_list = "";
+    const int page_count = std::max(1, ((int)filtered_entities.size() + INSPECTOR_PAGE_SIZE - 1) / INSPECTOR_PAGE_SIZE);
+    const int page_start = inspector_page * INSPECTOR_PAGE_SIZE;
+    const int page_end = std::min(page_start + INSPECTOR_PAGE_SIZE, (int)filtered_entities.size());
+
+    // Only the names on the current page are ever turned into text
+    if (entity_list_dirty) {
+        entity_list.clear();
+        inspector_list_active = -1;
+
+        for (int i = page_start; i < page_end; i++) {
+            int index = filtered_entities[i];
+            IDebug* entity = debug_entities[index];
+
+            if (!entity) {
+                entity_list.append(";- removed -");
+                continue;
+            }
 
-        for (IDebug* actor : debug_entities) {
-            entity_list.append(";");
-            entity_list.append(actor->get_name());
+            if (entity == selected_entity)
+                inspector_list_active = i - page_start;
+
+            entity_list.append(";").append(entity->get_name()).append(" ").append(std::to_string(index));
         }
 
         entity_list.erase(0, 1);
+        entity_list_dirty = false;
+    }
+
+    int inspector_list_active_previous = inspector_list_active;
 
+    if (page_start >= page_end) {
+        GuiPanel({ menu_rect.x + 8, menu_rect.y + 64, 128, 128 }, NULL);
+    } else {
         GuiListView(
             { menu_rect.x + 8, menu_rect.y + 64, 128, 128 },
             entity_list.c_str(),
@@ -296,14 +505,34 @@ void Debugger::render_inspector_menu(World* world)
             &inspector_list_active);
     }
 
-    if (GuiButton({ menu_rect.x + 152, menu_rect.y + 64, 120, 32 }, "Refresh")) {
+    if (inspector_list_active != inspector_list_active_previous) {
+        int i = page_start + inspector_list_active;
+        if (inspector_list_active >= 0 && i < page_end)
+            select_entity(debug_entities[filtered_entities[i]]);
+        else
+            select_entity(nullptr);
+    }
+
+    if (GuiButton({ menu_rect.x + 152, menu_rect.y + 32, 120, 24 }, "Refresh")) {
         build_inspector_menu(world);
     }
 
-    GuiLabel({ menu_rect.x + 152, menu_rect.y + 112, 120, 24 }, TextFormat("active = %d", inspector_list_active));
+    if (GuiButton({ menu_rect.x + 152, menu_rect.y + 64, 56, 24 }, "<") && inspector_page > 0) {
+        inspector_page -= 1;
+        inspector_list_scroll_index = 0;
+        entity_list_dirty = true;
+    }
+
+    if (GuiButton({ menu_rect.x + 216, menu_rect.y + 64, 56, 24 }, ">") && inspector_page < page_count - 1) {
+        inspector_page += 1;
+        inspector_list_scroll_index = 0;
+        entity_list_dirty = true;
+    }
 
-    // Check if a new entity has been selected
-    const bool entity_changed = inspector_list_active_previous != inspector_list_active;
+    GuiLabel({ menu_rect.x + 152, menu_rect.y + 96, 120, 24 }, TextFormat("page %d/%d", inspector_page + 1, page_count));
+    GuiLabel({ menu_rect.x + 152, menu_rect.y + 120, 120, 24 }, TextFormat("%d entities", (int)filtered_entities.size()));
+    GuiLabel({ menu_rect.x + 152, menu_rect.y + 144, 120, 24 }, "click world to pick");
+    GuiLabel({ menu_rect.x + 152, menu_rect.y + 168, 120, 24 }, "click name to plot");
 
     //----------------------------------------------
     // Bottom property selection + access area
@@ -311,42 +540,35 @@ void Debugger::render_inspector_menu(World* world)
     GuiLine({ menu_rect.x + 8, menu_rect.y + 192, 264, 16 }, NULL);
 
     float value_panel_height = menu_rect.height - menu_rect.y - 208;
-    float property_y = menu_rect.y + 208 + value_panel_height + 10;
 
     Rectangle property_list_rect = { menu_rect.x + 8, menu_rect.y + 208, 272, value_panel_height };
 
-    // We don't have a valid entity
-    if (inspector_list_active < 0 || inspector_list_active >= debug_entities.size()) {
+    // We don't have a valid entity or it has no properties
+    if (selected_entity == nullptr || entity_properties.size() == 0) {
         // Draw empty panel
         GuiPanel(property_list_rect, NULL);
+        return;
     }
 
-    // We have valid entity
-    else {
-
-        // We have a new entity
-        // Reset values and get it's properties
-        if (entity_changed) {
-            entity_properties.clear();
-            debug_entities[inspector_list_active]->get_properties(&entity_properties);
+    // Solids live in the broadphase, so let the world know if they were edited
+    Solid* solid = dynamic_cast<Solid*>(selected_entity);
+    Rectangle old_bounds = solid ? get_bounds(solid) : Rectangle { 0 };
 
-            entity_list_scroll_index = 0;
-        }
+    int clicked = GuiPropertyListView(property_list_rect, entity_properties, &entity_list_scroll_index, &entity_property_lines);
+    if (clicked >= 0)
+        toggle_plot(selected_entity, &entity_properties[clicked]);
 
-        // no properties
-        if (entity_properties.size() == 0) {
-            // Draw empty panel
-            GuiPanel(property_list_rect, NULL);
-            return;
-        }
-
-        GuiPropertyListView(property_list_rect, entity_properties, &entity_list_scroll_index);
+    if (solid) {
+        Rectangle new_bounds = get_bounds(solid);
+        if (memcmp(&old_bounds, &new_bounds, sizeof(Rectangle)) != 0)
+            world->refresh_entity_bounds(solid);
     }
 }
 
 void Debugger::build_inspector_menu(World* world)
 {
     debug_entities.clear();
+    debug_entity_indices.clear();
 
     for (Actor* actor : *world->get_actors()) {
         IDebug* debug_actor = dynamic_cast<IDebug*>(actor);
@@ -361,6 +583,103 @@ void Debugger::build_inspector_menu(World* world)
         if (debug_actor)
             debug_entities.push_back(debug_actor);
     }
+
+    for (Solid* solid : *world->get_solids())
+        debug_entities.push_back(solid);
+
+    for (int i = 0; i < debug_entities.size(); i++)
+        debug_entity_indices[debug_entities[i]] = i;
+
+    inspector_generation = world->get_entity_generation();
+    inspector_build_time = GetTime();
+
+    // Drop the selection if it has gone away
+    if (selected_entity && !debug_entity_indices.count(selected_entity))
+        select_entity(nullptr);
+
+    apply_inspector_filter();
+}
+
+void Debugger::apply_inspector_filter()
+{
+    filtered_entities.clear();
+
+    for (int i = 0; i < debug_entities.size(); i++) {
+        if (!debug_entities[i])
+            continue;
+
+        if (inspector_filter[0] == '\0' || strstr(debug_entities[i]->get_name(), inspector_filter))
+            filtered_entities.push_back(i);
+    }
+
+    const int page_count = std::max(1, ((int)filtered_entities.size() + INSPECTOR_PAGE_SIZE - 1) / INSPECTOR_PAGE_SIZE);
+    inspector_page = std::clamp(inspector_page, 0, page_count - 1);
+
+    entity_list_dirty = true;
+}
+
+void Debugger::select_entity(IDebug* entity)
+{
+    if (entity == selected_entity)
+        return;
+
+    selected_entity = entity;
+    entity_list_dirty = true;
+
+    entity_properties.clear();
+    entity_list_scroll_index = 0;
+    entity_property_lines = -1;
+
+    if (selected_entity)
+        selected_entity->get_properties(&entity_properties);
+}
+
+// Select whatever is under the mouse and jump the list to it
+void Debugger::pick_entity(World* world)
+{
+    Vector2 point = GetScreenToWorld2D(GetMousePosition(), world->camera.get_camera());
+    IDebug* picked = nullptr;
+
+    // Actors are drawn on top, last one is topmost
+    std::vector<Actor*>* actors = world->get_actors();
+    for (int i = actors->size() - 1; i >= 0 && !picked; i--) {
+        if (CheckCollisionPointRec(point, (*actors)[i]->get_rect()))
+            picked = dynamic_cast<IDebug*>((*actors)[i]);
+    }
+
+    if (!picked) {
+        for (CollisionEntity* solid : world->query_solids({ point.x, point.y, 0, 0 })) {
+            if (CheckCollisionPointRec(point, get_bounds(solid))) {
+                picked = dynamic_cast<IDebug*>(solid);
+                break;
+            }
+        }
+    }
+
+    if (!picked)
+        return;
+
+    if (world->get_entity_generation() != inspector_generation)
+        build_inspector_menu(world);
+
+    select_entity(picked);
+
+    auto index = debug_entity_indices.find(picked);
+    if (index == debug_entity_indices.end())
+        return;
+
+    // Filtered indices are in order
+    auto position = std::lower_bound(filtered_entities.begin(), filtered_entities.end(), index->second);
+    if (position == filtered_entities.end() || *position != index->second) {
+        inspector_filter[0] = '\0';
+        inspector_applied_filter[0] = '\0';
+        apply_inspector_filter();
+        position = std::lower_bound(filtered_entities.begin(), filtered_entities.end(), index->second);
+    }
+
+    inspector_page = (position - filtered_entities.begin()) / INSPECTOR_PAGE_SIZE;
+    inspector_list_scroll_index = 0;
+    entity_list_dirty = true;
 }
 
 void Debugger::render_physics_menu(World* world)
@@ -375,13 +694,19 @@ void Debugger::render_physics_menu(World* world)
     GuiLabel({ menu_rect.x + 24, menu_rect.y + 72, 120, 24 }, "Accumulator");
     GuiLabel({ menu_rect.x + 24, menu_rect.y + 96, 120, 24 }, "Timestep");
 
-    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 48, 120, 24 }, std::to_string(data->elapsed).c_str());
-    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 72, 120, 24 }, std::to_string(data->accumulator).c_str());
-    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 96, 120, 24 }, std::to_string(data->timestep).c_str());
+    physics_elapsed.set(data->elapsed);
+    physics_accumulator.set(data->accumulator);
+    physics_timestep.set(data->timestep);
+
+    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 48, 120, 24 }, physics_elapsed.text);
+    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 72, 120, 24 }, physics_accumulator.text);
+    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 96, 120, 24 }, physics_timestep.text);
 
     GuiLabel({ menu_rect.x + 24, menu_rect.y + 144, 120, 24 }, "Frames per second");
     GuiLabel({ menu_rect.x + 24, menu_rect.y + 168, 120, 24 }, "Fixed updates per second");
     GuiLabel({ menu_rect.x + 24, menu_rect.y + 192, 120, 24 }, "Freeze fixed updates");
+    GuiLabel({ menu_rect.x + 24, menu_rect.y + 216, 120, 24 }, "Parallel actors");
+    GuiLabel({ menu_rect.x + 24, menu_rect.y + 240, 120, 24 }, "Pipelined render");
 
     Vector2 mouse_pos = GetMousePosition();
     Rectangle edit_rect = { menu_rect.x + 144, menu_rect.y + 144, 120, 24 };
@@ -410,6 +735,31 @@ void Debugger::render_physics_menu(World* world)
     // Freeze
     edit_rect.y = menu_rect.y + 192;
     GuiCheckBox({ menu_rect.x + 144, menu_rect.y + 192, 24, 24 }, NULL, &data->freeze_fixed_update);
+
+    // Parallel actors
+    GuiCheckBox({ menu_rect.x + 144, menu_rect.y + 216, 24, 24 }, NULL, &data->parallel_actors);
+    GuiLabel(
+        { menu_rect.x + 176, menu_rect.y + 216, 96, 24 },
+        TextFormat("%d workers", world->get_jobs()->get_worker_count()));
+
+    // Pipelined render, switched over between frames while the sim thread is idle
+    GuiCheckBox({ menu_rect.x + 144, menu_rect.y + 240, 24, 24 }, NULL, &data->pipelined);
+
+    // Frame pacing, averaged over the last couple of seconds
+    const FrameStats& frame = world->get_frame_scheduler()->get_stats();
+
+    GuiLine({ menu_rect.x + 24, menu_rect.y + 272, 240, 16 }, FrameScheduler::is_pacing() ? "Frame pacing" : "Frame pacing (raylib)");
+    GuiLabel({ menu_rect.x + 24, menu_rect.y + 288, 120, 24 }, "Input to present");
+    GuiLabel({ menu_rect.x + 24, menu_rect.y + 312, 120, 24 }, "Frame time");
+    GuiLabel({ menu_rect.x + 24, menu_rect.y + 336, 120, 24 }, "Frame work");
+
+    GuiStatusBar(
+        { menu_rect.x + 144, menu_rect.y + 288, 120, 24 },
+        FrameScheduler::is_pacing() ? TextFormat("%.2fms", frame.latency * 1000.0) : "n/a");
+    GuiStatusBar(
+        { menu_rect.x + 144, menu_rect.y + 312, 120, 24 },
+        TextFormat("%.2f +- %.2fms", frame.frame_time * 1000.0, frame.frame_time_deviation * 1000.0));
+    GuiStatusBar({ menu_rect.x + 144, menu_rect.y + 336, 120, 24 }, TextFormat("%.2fms", frame.work_time * 1000.0));
 }
 
 void Debugger::render_player_menu(World* world)
@@ -422,20 +772,18 @@ void Debugger::render_player_menu(World* world)
         build_player_menu(world);
     }
 
-    if (GuiButton({ menu_rect.x + 24, menu_rect.y + 96, 120, 24 }, "Apply")) {
+    // No player until the level has loaded
+    if (GuiButton({ menu_rect.x + 24, menu_rect.y + 96, 120, 24 }, "Apply") && world->get_player()) {
         // player_slot1.
         Player* player = world->get_player();
         // world->get_player()->player_character_index = 0;
-        player->player_character_index = 0;
-
-        player->player_characters.clear();
-
+        std::vector<PlayerType> characters;
         for (auto val : player_slots) {
             PlayerType value = static_cast<PlayerType>(val);
-            player->player_characters.push_back(value);
+            characters.push_back(value);
         }
 
-        player->set_inner(player->player_characters[0]);
+        player->set_characters(characters, 0);
     }
 
     if (player_slots.size() > 1 && GuiButton({ menu_rect.x + 192, menu_rect.y + 144, 24, 24 }, "-")) {
@@ -469,12 +817,135 @@ void Debugger::build_player_menu(World* world)
 
     player_slots.clear();
 
+    if (!world->get_player())
+        return;
+
     for (PlayerType val : world->get_player()->player_characters) {
         int value = static_cast<int>(val);
         player_slots.push_back(value);
     }
 }
 
+void Debugger::render_plot_menu(World* world)
+{
+    if (GuiWindowBox(menu_rect, "Plot Menu")) {
+        current_menu = DebugMenu::Main;
+    }
+
+    if (GuiButton({ menu_rect.x + 24, menu_rect.y + 32, 120, 24 }, "Clear")) {
+        plot_count = 0;
+    }
+
+    if (plot_count == 0) {
+        GuiLabel({ menu_rect.x + 24, menu_rect.y + 64, 240, 24 }, "Click property names in the inspector");
+        return;
+    }
+
+    const float plot_height = std::fmax(32.0f, (menu_rect.height - 72) / MAX_PLOTS - 8);
+    const Color line_colors[2] = { RED, BLUE };
+    Vector2 points[PropertyPlot::SAMPLES];
+
+    for (int i = 0; i < plot_count; i++) {
+        PropertyPlot* plot = &plots[i];
+
+        Rectangle bounds = { menu_rect.x + 8, menu_rect.y + 64 + (plot_height + 8) * i, 272, plot_height };
+        GuiGroupBox(bounds, plot->name);
+
+        if (plot->count < 2)
+            continue;
+
+        // Oldest sample first
+        const int start = (plot->head - plot->count + PropertyPlot::SAMPLES) % PropertyPlot::SAMPLES;
+
+        float min_val = plot->samples[0][start];
+        float max_val = min_val;
+
+        for (int line = 0; line < plot->lines; line++) {
+            for (int x = 0; x < plot->count; x++) {
+                float value = plot->samples[line][(start + x) % PropertyPlot::SAMPLES];
+                min_val = std::fmin(min_val, value);
+                max_val = std::fmax(max_val, value);
+            }
+        }
+
+        const float range = std::fmax(max_val - min_val, 0.0001f);
+        Rectangle area = { bounds.x + 4, bounds.y + 12, bounds.width - 8, bounds.height - 16 };
+
+        for (int line = 0; line < plot->lines; line++) {
+            for (int x = 0; x < plot->count; x++) {
+                float value = plot->samples[line][(start + x) % PropertyPlot::SAMPLES];
+                points[x] = {
+                    area.x + area.width * x / (PropertyPlot::SAMPLES - 1),
+                    area.y + area.height * (1.0f - (value - min_val) / range),
+                };
+            }
+
+            DrawLineStrip(points, plot->count, line_colors[line]);
+        }
+
+        DrawText(TextFormat("%.2f", max_val), area.x, area.y, 10, DARKGRAY);
+        DrawText(TextFormat("%.2f", min_val), area.x, area.y + area.height - 10, 10, DARKGRAY);
+    }
+}
+
+// Start plotting a property, or stop if it is already plotted
+void Debugger::toggle_plot(IDebug* owner, DebugProperty* property)
+{
+    for (int i = 0; i < plot_count; i++) {
+        if (plots[i].owner == owner && strcmp(plots[i].name, property->name) == 0) {
+            plots[i] = plots[plot_count - 1];
+            plot_count -= 1;
+            return;
+        }
+    }
+
+    int lines = 0;
+    if (std::holds_alternative<int*>(property->property_type) || std::holds_alternative<float*>(property->property_type))
+        lines = 1;
+    else if (std::holds_alternative<Vector2*>(property->property_type))
+        lines = 2;
+
+    if (lines == 0 || plot_count >= MAX_PLOTS)
+        return;
+
+    PropertyPlot* plot = &plots[plot_count];
+    plot->owner = owner;
+    plot->entity = dynamic_cast<Entity*>(owner);
+    plot->name = property->name;
+    plot->lines = lines;
+    plot->head = 0;
+    plot->count = 0;
+
+    plot_count += 1;
+}
+
+// Called by the world for every entity it deletes, drops the plots it owned
+void Debugger::forget_entity(Entity* entity)
+{
+    for (int i = plot_count - 1; i >= 0; i--) {
+        if (plots[i].entity != entity)
+            continue;
+
+        plots[i] = plots[plot_count - 1];
+        plot_count -= 1;
+    }
+
+    IDebug* debug_entity = dynamic_cast<IDebug*>(entity);
+    if (!debug_entity)
+        return;
+
+    if (debug_entity == selected_entity)
+        select_entity(nullptr);
+
+    auto it = debug_entity_indices.find(debug_entity);
+    if (it == debug_entity_indices.end())
+        return;
+
+    debug_entities[it->second] = nullptr;
+    debug_entity_indices.erase(it);
+    entity_list_dirty = true;
+}
+
 //====================================================================
 // Level editor update and render
 
@@ -483,47 +954,416 @@ void Debugger::update_level_editor(World* world)
     if (!is_level_editor_enabled)
         return;
 
+    // The loaded level replaces everything once it arrives, edits made before then would be lost
+    if (world->is_level_loading()) {
+        is_brush_dragging = false;
+        return;
+    }
+
     world_mouse_pos = GetScreenToWorld2D(GetMousePosition(), world->camera.get_camera());
 
     snapped_mouse_x = round_to(world_mouse_pos.x, TILE_WIDTH);
     snapped_mouse_y = round_to(world_mouse_pos.y, TILE_HEIGHT);
 
+    bool mouse_left = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+    bool mouse_right = IsMouseButtonDown(MOUSE_BUTTON_RIGHT);
+
+    // One stroke per drag
+    if (!mouse_left && !mouse_right && edit_history.is_recording())
+        edit_history.end_stroke();
+
+    // Undo/Redo
+    bool control = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    bool shift = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+
+    if (control && IsKeyPressed(KEY_Z) && !shift)
+        undo_edit(world);
+    else if (control && (IsKeyPressed(KEY_Y) || (IsKeyPressed(KEY_Z) && shift)))
+        redo_edit(world);
+
+    // Brushes
+    if (IsKeyPressed(KEY_ONE))
+        editor_brush = EditorBrush::Pencil;
+    if (IsKeyPressed(KEY_TWO))
+        editor_brush = EditorBrush::Rectangle;
+    if (IsKeyPressed(KEY_THREE))
+        editor_brush = EditorBrush::Fill;
+
+    if (editor_brush != EditorBrush::Rectangle)
+        is_brush_dragging = false;
+
+    // Finish the rectangle even if the mouse was let go over the menu
+    if (is_brush_dragging) {
+        int button = brush_erase ? MOUSE_BUTTON_RIGHT : MOUSE_BUTTON_LEFT;
+        if (IsMouseButtonReleased(button)) {
+            is_brush_dragging = false;
+            fill_rectangle(world, brush_start_x, brush_start_y, snapped_mouse_x / TILE_WIDTH, snapped_mouse_y / TILE_HEIGHT, brush_erase);
+        }
+    }
+
     // Skip if mouse in menu
     if (is_debug_menu && CheckCollisionPointRec(GetMousePosition(), menu_rect))
         return;
 
-    bool mouse_left = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
-    bool mouse_right = IsMouseButtonDown(MOUSE_BUTTON_RIGHT);
+    bool left_pressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    bool right_pressed = IsMouseButtonPressed(MOUSE_BUTTON_RIGHT);
 
-    if (mouse_left || mouse_right) {
+    switch (editor_brush) {
+    case EditorBrush::Pencil:
+        update_pencil_brush(world, mouse_left, mouse_right);
+        break;
 
-        int half_width = TILE_WIDTH / 2;
-        int half_height = TILE_HEIGHT / 2;
+    case EditorBrush::Rectangle:
+        if (!is_brush_dragging && (left_pressed || right_pressed)) {
+            is_brush_dragging = true;
+            brush_erase = !left_pressed;
+            brush_start_x = snapped_mouse_x / TILE_WIDTH;
+            brush_start_y = snapped_mouse_y / TILE_HEIGHT;
+        }
+        break;
 
-        Solid* new_tile = new Solid(
-            { (float)snapped_mouse_x + half_width, (float)snapped_mouse_y + half_height },
-            half_width,
-            half_height);
+    case EditorBrush::Fill:
+        if (left_pressed || right_pressed)
+            flood_fill(world, snapped_mouse_x / TILE_WIDTH, snapped_mouse_y / TILE_HEIGHT, !left_pressed);
+        break;
+    }
+}
+
+void Debugger::update_pencil_brush(World* world, bool mouse_left, bool mouse_right)
+{
+    if (!mouse_left && !mouse_right)
+        return;
 
-        for (Collision collision : world->check_collision(new_tile)) {
-            auto* derived = dynamic_cast<Solid*>(collision.entity);
-            if (derived)
-                world->destroy_solid(derived);
+    if (!edit_history.is_recording())
+        edit_history.begin_stroke();
+
+    int half_width = TILE_WIDTH / 2;
+    int half_height = TILE_HEIGHT / 2;
+
+    Solid* new_tile = new Solid(
+        { (float)snapped_mouse_x + half_width, (float)snapped_mouse_y + half_height },
+        half_width,
+        half_height);
+
+    std::vector<Collision> collisions = world->check_collision(new_tile);
+
+    // Already painted, don't churn the same tile every frame
+    if (mouse_left && collisions.size() == 1 && same_tile(collisions[0].entity, new_tile)) {
+        delete new_tile;
+        return;
+    }
+
+    for (Collision collision : collisions) {
+        auto* derived = dynamic_cast<Solid*>(collision.entity);
+        if (derived) {
+            record_edit(world, to_tile_edit(derived, false));
+            world->destroy_solid(derived);
         }
+    }
 
-        // add tile if addition
-        if (mouse_left)
-            world->add_solid(new_tile);
+    // add tile if addition
+    if (mouse_left) {
+        record_edit(world, to_tile_edit(new_tile, true));
+        world->add_solid(new_tile);
+    }
 
-        // delete temp tile if removal
-        else
-            delete new_tile;
+    // delete temp tile if removal
+    else
+        delete new_tile;
+}
+
+//====================================================================
+// Level editor - bulk brushes
+
+static int floor_div(int num, int divisor)
+{
+    int result = num / divisor;
+    if ((num % divisor != 0) && ((num < 0) != (divisor < 0)))
+        result -= 1;
+    return result;
+}
+
+static long long cell_key(int x, int y)
+{
+    return ((long long)x << 32) ^ (long long)(unsigned int)y;
+}
+
+static Rectangle cell_area(int x1, int y1, int x2, int y2)
+{
+    return {
+        (float)x1 * TILE_WIDTH,
+        (float)y1 * TILE_HEIGHT,
+        (float)(x2 - x1 + 1) * TILE_WIDTH,
+        (float)(y2 - y1 + 1) * TILE_HEIGHT,
+    };
+}
+
+void Debugger::fill_rectangle(World* world, int x1, int y1, int x2, int y2, bool erase)
+{
+    if (x1 > x2)
+        std::swap(x1, x2);
+    if (y1 > y2)
+        std::swap(y1, y2);
+
+    long long count = (long long)(x2 - x1 + 1) * (y2 - y1 + 1);
+    if (count > MAX_BRUSH_TILES) {
+        world->log_format(1, "Rectangle too large - %lld tiles", count);
+        return;
     }
+
+    brush_cells.clear();
+    brush_cells.reserve(count);
+
+    for (int y = y1; y <= y2; y++) {
+        for (int x = x1; x <= x2; x++)
+            brush_cells.push_back({ x, y });
+    }
+
+    paint_tiles(world, world->query_solids(cell_area(x1, y1, x2, y2)), erase);
+}
+
+// Fills the empty area around a cell, or erases the tiles connected to it. The search is
+// limited to FLOOD_RADIUS cells around the start, a fill or erase that reaches the edge of
+// that is cancelled rather than applied to only part of the area
+void Debugger::flood_fill(World* world, int start_x, int start_y, bool erase)
+{
+    const int size = FLOOD_RADIUS * 2 + 1;
+    const int origin_x = start_x - FLOOD_RADIUS;
+    const int origin_y = start_y - FLOOD_RADIUS;
+
+    std::vector<CollisionEntity*> candidates = world->query_solids(
+        cell_area(origin_x, origin_y, origin_x + size - 1, origin_y + size - 1));
+
+    // Rasterize every solid in range into cells
+    std::vector<char> occupied(size * size, 0);
+
+    for (CollisionEntity* entity : candidates) {
+        Rectangle bounds = get_bounds(entity);
+
+        int x1 = std::max(floor_div((int)std::floor(bounds.x), TILE_WIDTH) - origin_x, 0);
+        int y1 = std::max(floor_div((int)std::floor(bounds.y), TILE_HEIGHT) - origin_y, 0);
+        int x2 = std::min(floor_div((int)std::ceil(bounds.x + bounds.width) - 1, TILE_WIDTH) - origin_x, size - 1);
+        int y2 = std::min(floor_div((int)std::ceil(bounds.y + bounds.height) - 1, TILE_HEIGHT) - origin_y, size - 1);
+
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++)
+                occupied[y * size + x] = 1;
+        }
+    }
+
+    // Spread through cells in the same state as the start
+    const char target = erase ? 1 : 0;
+    const int start = FLOOD_RADIUS * size + FLOOD_RADIUS;
+
+    if (occupied[start] != target)
+        return;
+
+    std::vector<char> visited(size * size, 0);
+    std::vector<int> open = { start };
+    visited[start] = 1;
+
+    brush_cells.clear();
+
+    while (!open.empty()) {
+        int index = open.back();
+        open.pop_back();
+
+        int x = index % size;
+        int y = index / size;
+
+        if (x == 0 || y == 0 || x == size - 1 || y == size - 1) {
+            if (erase)
+                world->log(TextFormat("Erase reaches further than %d tiles", FLOOD_RADIUS), 1);
+            else
+                world->log(TextFormat("Fill not enclosed within %d tiles", FLOOD_RADIUS), 1);
+            return;
+        }
+
+        brush_cells.push_back({ origin_x + x, origin_y + y });
+
+        const int neighbours[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+        for (auto& offset : neighbours) {
+            int nx = x + offset[0];
+            int ny = y + offset[1];
+
+            if (nx < 0 || ny < 0 || nx >= size || ny >= size)
+                continue;
+
+            int next = ny * size + nx;
+            if (visited[next] || occupied[next] != target)
+                continue;
+
+            visited[next] = 1;
+            open.push_back(next);
+        }
+    }
+
+    paint_tiles(world, candidates, erase);
+}
+
+// Applies brush_cells as a single edit. Overlapping solids come from one broadphase query
+// made by the caller, the world then adds and removes everything in one deferred batch
+void Debugger::paint_tiles(World* world, const std::vector<CollisionEntity*>& candidates, bool erase)
+{
+    if (brush_cells.empty())
+        return;
+
+    int min_x = brush_cells[0].x;
+    int min_y = brush_cells[0].y;
+    int max_x = min_x;
+    int max_y = min_y;
+
+    std::unordered_set<long long> targets;
+    targets.reserve(brush_cells.size());
+
+    for (const TileCell& cell : brush_cells) {
+        targets.insert(cell_key(cell.x, cell.y));
+        min_x = std::min(min_x, cell.x);
+        min_y = std::min(min_y, cell.y);
+        max_x = std::max(max_x, cell.x);
+        max_y = std::max(max_y, cell.y);
+    }
+
+    const int half_width = TILE_WIDTH / 2;
+    const int half_height = TILE_HEIGHT / 2;
+
+    // Tiles that are already exactly where the fill would put them
+    std::unordered_set<long long> kept;
+
+    edit_history.begin_stroke();
+    int removed = 0;
+    int added = 0;
+
+    for (CollisionEntity* entity : candidates) {
+        Solid* solid = dynamic_cast<Solid*>(entity);
+        if (!solid)
+            continue;
+
+        Rectangle bounds = get_bounds(solid);
+        int x1 = floor_div((int)std::floor(bounds.x), TILE_WIDTH);
+        int y1 = floor_div((int)std::floor(bounds.y), TILE_HEIGHT);
+        int x2 = floor_div((int)std::ceil(bounds.x + bounds.width) - 1, TILE_WIDTH);
+        int y2 = floor_div((int)std::ceil(bounds.y + bounds.height) - 1, TILE_HEIGHT);
+
+        bool is_tile = x1 == x2 && y1 == y2
+            && solid->half_width == half_width && solid->half_height == half_height
+            && (int)solid->pos.x == x1 * TILE_WIDTH + half_width
+            && (int)solid->pos.y == y1 * TILE_HEIGHT + half_height;
+
+        if (!erase && is_tile && targets.count(cell_key(x1, y1)) && kept.insert(cell_key(x1, y1)).second)
+            continue;
+
+        bool hit = false;
+        for (int y = std::max(y1, min_y); y <= std::min(y2, max_y) && !hit; y++) {
+            for (int x = std::max(x1, min_x); x <= std::min(x2, max_x) && !hit; x++)
+                hit = targets.count(cell_key(x, y)) > 0;
+        }
+
+        if (!hit)
+            continue;
+
+        record_edit(world, to_tile_edit(solid, false));
+        world->destroy_solid(solid);
+        removed += 1;
+    }
+
+    if (!erase) {
+        for (const TileCell& cell : brush_cells) {
+            if (kept.count(cell_key(cell.x, cell.y)))
+                continue;
+
+            Solid* tile = new Solid(
+                { (float)cell.x * TILE_WIDTH + half_width, (float)cell.y * TILE_HEIGHT + half_height },
+                half_width,
+                half_height);
+
+            record_edit(world, to_tile_edit(tile, true));
+            world->add_solid(tile);
+            added += 1;
+        }
+    }
+
+    edit_history.end_stroke();
+    brush_cells.clear();
+
+    world->log_format(1, "Brush - %d added, %d removed", added, removed);
+}
+
+bool Debugger::same_tile(CollisionEntity* a, CollisionEntity* b)
+{
+    return (int)a->pos.x == (int)b->pos.x
+        && (int)a->pos.y == (int)b->pos.y
+        && a->half_width == b->half_width
+        && a->half_height == b->half_height;
+}
+
+TileEdit Debugger::to_tile_edit(CollisionEntity* entity, bool added)
+{
+    return { (int)entity->pos.x, (int)entity->pos.y, entity->half_width, entity->half_height, added };
+}
+
+// The level was replaced or changed underneath the editor, its history no longer applies
+void Debugger::on_level_changed()
+{
+    edit_history.clear();
+    is_brush_dragging = false;
+}
+
+// Undo history and the level journal both see every editor change
+void Debugger::record_edit(World* world, const TileEdit& edit)
+{
+    edit_history.record(edit);
+    world->record_edit(edit);
+}
+
+// Re-apply a single journaled change through the world's add/destroy paths
+void Debugger::apply_tile_edit(World* world, const TileEdit& edit)
+{
+    world->record_edit(edit);
+
+    Solid tile({ (float)edit.x, (float)edit.y }, edit.half_width, edit.half_height);
+
+    if (edit.added) {
+        world->add_solid(new Solid(tile.pos, tile.half_width, tile.half_height));
+        return;
+    }
+
+    for (CollisionEntity* entity : world->query_solids(get_bounds(&tile))) {
+        Solid* solid = dynamic_cast<Solid*>(entity);
+        if (solid && same_tile(solid, &tile)) {
+            world->destroy_solid(solid);
+            return;
+        }
+    }
+}
+
+void Debugger::undo_edit(World* world)
+{
+    history_edits.clear();
+    if (!edit_history.undo(&history_edits))
+        return;
+
+    for (const TileEdit& edit : history_edits)
+        apply_tile_edit(world, edit);
+
+    world->log_format(1, "Undo - %d tiles", (int)history_edits.size());
+}
+
+void Debugger::redo_edit(World* world)
+{
+    history_edits.clear();
+    if (!edit_history.redo(&history_edits))
+        return;
+
+    for (const TileEdit& edit : history_edits)
+        apply_tile_edit(world, edit);
+
+    world->log_format(1, "Redo - %d tiles", (int)history_edits.size());
 }
 
 void Debugger::render_level_editor(World* world)
 {
-    if (!is_level_editor_enabled)
+    if (!is_level_editor_enabled || world->is_level_loading())
         return;
 
     // Draw mouse tile
@@ -534,6 +1374,23 @@ void Debugger::render_level_editor(World* world)
         TILE_HEIGHT,
         Fade(BLUE, 0.4));
 
+    // Draw rectangle brush
+    if (is_brush_dragging) {
+        int x1 = std::min(brush_start_x * TILE_WIDTH, snapped_mouse_x);
+        int y1 = std::min(brush_start_y * TILE_HEIGHT, snapped_mouse_y);
+        int x2 = std::max(brush_start_x * TILE_WIDTH, snapped_mouse_x) + TILE_WIDTH;
+        int y2 = std::max(brush_start_y * TILE_HEIGHT, snapped_mouse_y) + TILE_HEIGHT;
+
+        DrawRectangle(x1, y1, x2 - x1, y2 - y1, Fade(brush_erase ? RED : BLUE, 0.3));
+    }
+
+    DrawText(
+        magic_enum::enum_name(editor_brush).data(),
+        snapped_mouse_x,
+        snapped_mouse_y - 14,
+        10,
+        BLACK);
+
     // Draw Grid
     Vector2 pos = GetScreenToWorld2D({ 0, 0 }, world->camera.get_camera());
 
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "edit_history.hpp"
+#include "level_thumbnails.hpp"
+#include "message_ring.hpp"
 #include "raylib.h"
+#include <cstdarg>
+#include <cstdio>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -13,11 +19,38 @@ enum class DebugMenu {
     Inspector,
     Physics,
     Player,
+    Plots,
+};
+
+enum class EditorBrush {
+    Pencil,
+    Rectangle,
+    Fill,
 };
 
 // TODO - add spacing decorative variant + other variants
 using PropertyType = std::variant<int*, bool*, float*, Vector2*>;
 
+// Debug log channel, messages are formatted in place into fixed size slots
+using LogRing = MessageRing<128, 128>;
+
+// Label text for a float, only reformatted when the value changes
+struct CachedFloatText {
+    float value = 0.0f;
+    bool valid = false;
+    char text[32] = { 0 };
+
+    inline void set(float new_value)
+    {
+        if (valid && new_value == value)
+            return;
+
+        value = new_value;
+        valid = true;
+        snprintf(text, sizeof(text), "%f", value);
+    }
+};
+
 struct DebugProperty {
     const char* name;
     PropertyType property_type;
@@ -27,20 +60,41 @@ struct DebugProperty {
     float scroll_scale = 1;
 };
 
+// Recent values of an inspector property, sampled every fixed update
+struct PropertyPlot {
+    static const int SAMPLES = 240;
+
+    class IDebug* owner = nullptr;
+    // Same object as owner, what the world hands to forget_entity
+    class Entity* entity = nullptr;
+    const char* name = nullptr;
+    int lines = 0;
+
+    float samples[2][SAMPLES];
+    int head = 0;
+    int count = 0;
+};
+
 class Debugger {
 public:
     Debugger();
+
+    // Safe to call from any thread
     void add_message(const char* text, int log);
+    void add_message_v(int log, const char* format, va_list args);
 
 private:
     void update(class World* world);
+    void fixed_update(class World* world);
     void render_2d(class World* world);
     void render(class World* world);
+    void unload();
     friend class World;
 
 private:
     // Logging
-    void render_log(std::vector<std::string>* messages, int index);
+    void render_log(int index, int header_count);
+    void discard_log();
 
     // Debug menu
     void resize_debug_menu();
@@ -51,18 +105,38 @@ private:
 
     void render_inspector_menu(World* world);
     void build_inspector_menu(World* world);
+    void apply_inspector_filter();
+    void select_entity(class IDebug* entity);
+    void pick_entity(World* world);
 
     void render_physics_menu(World* world);
 
     void render_player_menu(World* world);
     void build_player_menu(World* world);
 
+    void render_plot_menu(World* world);
+    void toggle_plot(class IDebug* owner, DebugProperty* property);
+    void forget_entity(class Entity* entity);
+
     // Level stuff
     void destroy_tile(World* world);
 
     void update_level_editor(class World* world);
     void render_level_editor(class World* world);
 
+    void update_pencil_brush(World* world, bool mouse_left, bool mouse_right);
+    void fill_rectangle(World* world, int x1, int y1, int x2, int y2, bool erase);
+    void flood_fill(World* world, int start_x, int start_y, bool erase);
+    void paint_tiles(World* world, const std::vector<class CollisionEntity*>& candidates, bool erase);
+
+    void undo_edit(World* world);
+    void redo_edit(World* world);
+    void on_level_changed();
+    void record_edit(World* world, const TileEdit& edit);
+    void apply_tile_edit(World* world, const TileEdit& edit);
+    static bool same_tile(class CollisionEntity* a, class CollisionEntity* b);
+    static TileEdit to_tile_edit(class CollisionEntity* entity, bool added);
+
 private:
     // Toggles
     bool is_log_enabled = false;
@@ -79,34 +153,106 @@ private:
     // Debug Menu - Level Select
     int level_list_scroll_index = 0;
     int level_list_active = -1;
-    std::vector<const char*> levels;
-    std::string levels_name_list;
+    LevelThumbnails level_thumbnails;
+    unsigned int level_menu_generation = 0;
+
+    int level_info_index = -2;
+    char level_info_text[64] = "";
     char level_menu_name[128] = "Level Name";
 
     // Debug Menu - Inspector
+    static const int INSPECTOR_PAGE_SIZE = 64;
+
     int inspector_list_scroll_index = 0;
     int inspector_list_active = -1;
+    int inspector_page = 0;
+    char inspector_filter[64] = "";
+    char inspector_applied_filter[64] = "";
 
+    // Added entities show up on the next rebuild, at most this often while the level changes
+    static constexpr double INSPECTOR_REBUILD_INTERVAL = 0.5;
+
+    // Removed entities are set to nullptr as they go, so nothing here is ever stale
     std::vector<class IDebug*> debug_entities;
+    std::unordered_map<class IDebug*, int> debug_entity_indices;
+    std::vector<int> filtered_entities;
+    unsigned int inspector_generation = 0;
+    double inspector_build_time = 0.0;
+
+    class IDebug* selected_entity = nullptr;
     int entity_list_scroll_index = 0;
 
+    // Labels for the current page only, rebuilt when the page, filter or entities change
+    std::string entity_list;
+    bool entity_list_dirty = true;
+
     std::vector<DebugProperty> entity_properties;
+    // Height of entity_properties in rows, -1 until the list view has summed it
+    int entity_property_lines = -1;
+
+    // Debug Menu - Physics
+    CachedFloatText physics_elapsed;
+    CachedFloatText physics_accumulator;
+    CachedFloatText physics_timestep;
 
     // Debug Menu - Player
     std::string player_options;
     std::vector<int> player_slots;
 
+    // Debug Menu - Plots
+    static const int MAX_PLOTS = 4;
+
+    PropertyPlot plots[MAX_PLOTS];
+    int plot_count = 0;
+
+    // Reused every sample so pointers are always fresh, even if the owner swapped its internals
+    std::vector<DebugProperty> plot_properties;
+
     //----------------------------------------------
     // Logging stuff
-    std::vector<std::string> messages_0;
-    std::vector<std::string> messages_1;
-    std::vector<std::string> messages_2;
+    static const int LOG_CHANNELS = 3;
+    static const int LOG_HEADER_LINES = 4;
+
+    LogRing messages[LOG_CHANNELS];
+
+    // Lines drained from a channel for drawing, channel 0 starts with the frame stats
+    char log_lines[LOG_HEADER_LINES + LogRing::capacity][LogRing::slot_size];
+
+    // Last frame's stats, channel 0 is redrawn only when one of them changes
+    char log_stats[LOG_HEADER_LINES][LogRing::slot_size] = { 0 };
+
+    struct LogCache {
+        RenderTexture2D texture = { 0 };
+        int line_count = 0;
+        bool dirty = true;
+    };
+
+    LogCache log_cache[LOG_CHANNELS];
 
     //----------------------------------------------
     // Level editor stuff
     Vector2 world_mouse_pos;
     int snapped_mouse_x;
     int snapped_mouse_y;
+
+    // Level editor - brushes, all in tile coordinates
+    static const int MAX_BRUSH_TILES = 1 << 16;
+    static const int FLOOD_RADIUS = 96;
+
+    struct TileCell {
+        int x;
+        int y;
+    };
+
+    EditorBrush editor_brush = EditorBrush::Pencil;
+    bool is_brush_dragging = false;
+    bool brush_erase = false;
+    int brush_start_x = 0;
+    int brush_start_y = 0;
+    std::vector<TileCell> brush_cells;
+
+    EditHistory edit_history;
+    std::vector<TileEdit> history_edits;
 };
 
 class IDebug {
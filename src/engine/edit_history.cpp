@@ -0,0 +1,154 @@
+#include "edit_history.hpp"
+
+//====================================================================
+
+EditHistory::EditHistory(int max_edits)
+    : max_edits(max_edits)
+{
+}
+
+// Position and size packed together, tiles in the same spot with the same size share a key
+long long EditHistory::edit_key(const TileEdit& edit)
+{
+    return ((long long)(edit.x & 0xFFFFFF) << 40)
+        ^ ((long long)(edit.y & 0xFFFFFF) << 16)
+        ^ ((long long)(edit.half_width & 0xFF) << 8)
+        ^ (long long)(edit.half_height & 0xFF);
+}
+
+void EditHistory::begin_stroke()
+{
+    if (recording)
+        end_stroke();
+
+    recording = true;
+    pending.clear();
+    pending_cancelled.clear();
+    pending_index.clear();
+}
+
+void EditHistory::record(TileEdit edit)
+{
+    if (!recording)
+        begin_stroke();
+
+    const long long key = edit_key(edit);
+    auto it = pending_index.find(key);
+
+    // Added then removed (or the other way round) in the same stroke, nothing happened
+    if (it != pending_index.end()) {
+        TileEdit& previous = pending[it->second];
+        bool same = previous.x == edit.x && previous.y == edit.y
+            && previous.half_width == edit.half_width && previous.half_height == edit.half_height;
+
+        if (same && previous.added != edit.added && !pending_cancelled[it->second]) {
+            pending_cancelled[it->second] = true;
+            pending_index.erase(it);
+            return;
+        }
+    }
+
+    pending_index[key] = pending.size();
+    pending.push_back(edit);
+    pending_cancelled.push_back(false);
+}
+
+void EditHistory::end_stroke()
+{
+    if (!recording)
+        return;
+
+    recording = false;
+
+    int count = 0;
+    for (int i = 0; i < pending.size(); i++)
+        count += !pending_cancelled[i];
+
+    if (count == 0)
+        return;
+
+    // A new stroke throws away anything that could have been redone
+    while (strokes.size() > applied_strokes) {
+        int stroke = strokes.back();
+        strokes.pop_back();
+        edits.erase(edits.end() - stroke, edits.end());
+    }
+
+    for (int i = 0; i < pending.size(); i++) {
+        if (!pending_cancelled[i])
+            edits.push_back(pending[i]);
+    }
+
+    strokes.push_back(count);
+    applied_strokes += 1;
+    applied_edits += count;
+
+    // Forget the oldest strokes, always keeping the newest one
+    while (edits.size() > max_edits && strokes.size() > 1) {
+        int stroke = strokes.front();
+        strokes.pop_front();
+        edits.erase(edits.begin(), edits.begin() + stroke);
+
+        applied_strokes -= 1;
+        applied_edits -= stroke;
+    }
+
+    pending.clear();
+    pending_cancelled.clear();
+    pending_index.clear();
+}
+
+void EditHistory::clear()
+{
+    edits.clear();
+    strokes.clear();
+    applied_strokes = 0;
+    applied_edits = 0;
+
+    recording = false;
+    pending.clear();
+    pending_cancelled.clear();
+    pending_index.clear();
+}
+
+//====================================================================
+
+bool EditHistory::undo(std::vector<TileEdit>* out)
+{
+    if (recording)
+        end_stroke();
+
+    if (!can_undo())
+        return false;
+
+    applied_strokes -= 1;
+    int stroke = strokes[applied_strokes];
+    applied_edits -= stroke;
+
+    for (int i = applied_edits + stroke - 1; i >= applied_edits; i--) {
+        TileEdit edit = edits[i];
+        edit.added = !edit.added;
+        out->push_back(edit);
+    }
+
+    return true;
+}
+
+bool EditHistory::redo(std::vector<TileEdit>* out)
+{
+    if (recording)
+        end_stroke();
+
+    if (!can_redo())
+        return false;
+
+    int stroke = strokes[applied_strokes];
+
+    for (int i = applied_edits; i < applied_edits + stroke; i++)
+        out->push_back(edits[i]);
+
+    applied_strokes += 1;
+    applied_edits += stroke;
+
+    return true;
+}
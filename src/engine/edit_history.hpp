@@ -0,0 +1,57 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+//====================================================================
+// Level editor undo/redo journal
+//
+// Edits are grouped into strokes, one per mouse drag. Within a stroke, a tile
+// that is added and removed again cancels out. Once the journal holds more
+// than max_edits edits, the oldest strokes are forgotten.
+
+struct TileEdit {
+    int x;
+    int y;
+    int half_width;
+    int half_height;
+    bool added;
+};
+
+class EditHistory {
+public:
+    EditHistory(int max_edits = 1 << 16);
+
+    void begin_stroke();
+    void record(TileEdit edit);
+    void end_stroke();
+    void clear();
+
+    inline bool is_recording() { return recording; }
+    inline bool can_undo() { return applied_strokes > 0; }
+    inline bool can_redo() { return applied_strokes < strokes.size(); }
+
+    // Edits of the stroke to revert, in the order they should be undone (inverted already)
+    bool undo(std::vector<TileEdit>* out);
+    // Edits of the stroke to re-apply, in order
+    bool redo(std::vector<TileEdit>* out);
+
+private:
+    static long long edit_key(const TileEdit& edit);
+
+private:
+    int max_edits;
+
+    std::deque<TileEdit> edits;
+    std::deque<int> strokes;
+
+    int applied_strokes = 0;
+    int applied_edits = 0;
+
+    // Open stroke
+    bool recording = false;
+    std::vector<TileEdit> pending;
+    std::vector<bool> pending_cancelled;
+    std::unordered_map<long long, int> pending_index;
+};
@@ -1,5 +1,8 @@
 #include "entity.hpp"
 
+#include "render_snapshot.hpp"
+#include "world_snapshot.hpp"
+
 //====================================================================
 
 Entity::Entity()
@@ -12,6 +15,16 @@ Entity::Entity(Vector2 new_pos)
     pos = new_pos;
 }
 
+void Entity::save_state(StateWriter& writer)
+{
+    writer(pos);
+}
+
+void Entity::load_state(StateReader& reader)
+{
+    reader(pos);
+}
+
 //====================================================================
 
 CollisionEntity::CollisionEntity()
@@ -38,6 +51,31 @@ void CollisionEntity::render(World* world)
         GREEN);
 }
 
+void CollisionEntity::save_state(StateWriter& writer)
+{
+    writer(pos);
+    writer(half_width);
+    writer(half_height);
+}
+
+void CollisionEntity::load_state(StateReader& reader)
+{
+    reader(pos);
+    reader(half_width);
+    reader(half_height);
+}
+
+void CollisionEntity::capture(RenderSnapshot* snapshot)
+{
+    Rectangle rect = {
+        (float)(int)(pos.x - half_width),
+        (float)(int)(pos.y - half_height),
+        (float)(half_width * 2),
+        (float)(half_height * 2),
+    };
+    snapshot->add_rect(rect, GREEN);
+}
+
 //====================================================================
 
 Rectangle Actor::get_rect()
@@ -50,7 +88,7 @@ Rectangle Actor::get_rect()
     };
 }
 
-void Actor::get_properties(std::vector<DebugProperty>* properties)
+void CollisionEntity::get_collision_properties(std::vector<DebugProperty>* properties)
 {
     properties->push_back({ "position", &pos, true, -99999999.0f, 99999999.0f });
     properties->push_back({ "half_width", &half_width, true, -99999999.0f, 99999999.0f });
@@ -59,6 +97,20 @@ void Actor::get_properties(std::vector<DebugProperty>* properties)
 
 //====================================================================
 
+void Actor::get_properties(std::vector<DebugProperty>* properties)
+{
+    get_collision_properties(properties);
+}
+
+//====================================================================
+
+void Solid::get_properties(std::vector<DebugProperty>* properties)
+{
+    get_collision_properties(properties);
+}
+
+//----------------------------------------------
+
 RawSolid::RawSolid(int x, int y, int half_width, int half_height)
     : RawEntity(x, y)
     , half_width(half_width)
@@ -13,10 +13,16 @@ public:
     Entity();
     Entity(Vector2 pos);
 
-    ~Entity() { }
+    virtual ~Entity() { }
     virtual void update(class World* world) {};
     virtual void fixed_update(class World* world, float dt) {};
     virtual void render(class World* world) {};
+    // Same as render, but into a snapshot that is drawn later
+    virtual void capture(class RenderSnapshot* snapshot) {};
+
+    // Simulation state for world snapshots, load must read exactly what save wrote
+    virtual void save_state(class StateWriter& writer);
+    virtual void load_state(class StateReader& reader);
 
     Vector2 pos;
 };
@@ -31,9 +37,16 @@ public:
     CollisionEntity(Vector2 pos, int h_width, int h_height);
 
     virtual void render(class World* world) override;
+    virtual void capture(class RenderSnapshot* snapshot) override;
+
+    virtual void save_state(class StateWriter& writer) override;
+    virtual void load_state(class StateReader& reader) override;
 
     int half_width;
     int half_height;
+
+protected:
+    void get_collision_properties(std::vector<DebugProperty>* properties);
 };
 
 //====================================================================
@@ -53,11 +66,15 @@ public:
 //====================================================================
 // Solid class
 
-class Solid : public CollisionEntity, public IToRawData {
+class Solid : public CollisionEntity, public IToRawData, public IDebug {
     using CollisionEntity::CollisionEntity;
 
 public:
     virtual std::unique_ptr<class RawEntity> ToRaw() override;
+
+public:
+    virtual inline const char* get_name() override { return "solid"; }
+    virtual void get_properties(std::vector<DebugProperty>* properties) override;
 };
 
 //----------------------------------------------
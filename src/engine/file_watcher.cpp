@@ -0,0 +1,94 @@
+#include "file_watcher.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//====================================================================
+
+FileWatcher::~FileWatcher()
+{
+    stop();
+}
+
+#ifdef __linux__
+
+bool FileWatcher::watch(const std::string& directory)
+{
+    stop();
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    // Writes are only reported once the file is closed, so half written files are never picked up
+    watch_descriptor = inotify_add_watch(
+        fd,
+        directory.c_str(),
+        IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+
+    if (watch_descriptor < 0) {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FileWatcher::stop()
+{
+    if (fd < 0)
+        return;
+
+    if (watch_descriptor >= 0)
+        inotify_rm_watch(fd, watch_descriptor);
+
+    close(fd);
+    fd = -1;
+    watch_descriptor = -1;
+}
+
+bool FileWatcher::poll(std::vector<std::string>* changed)
+{
+    if (fd < 0)
+        return true;
+
+    alignas(inotify_event) char buffer[4096];
+    bool complete = true;
+
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            inotify_event* event = (inotify_event*)ptr;
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+                complete = false;
+            else if (event->len > 0)
+                changed->push_back(event->name);
+        }
+    }
+
+    return complete;
+}
+
+#else
+
+bool FileWatcher::watch(const std::string& directory)
+{
+    return false;
+}
+
+void FileWatcher::stop() { }
+
+bool FileWatcher::poll(std::vector<std::string>* changed)
+{
+    return true;
+}
+
+#endif
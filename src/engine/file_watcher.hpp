@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//====================================================================
+// Directory change notifications
+//
+// Uses inotify on Linux. Elsewhere watch() fails and callers should fall
+// back to checking modification times themselves.
+
+class FileWatcher {
+public:
+    FileWatcher() { }
+    ~FileWatcher();
+
+    bool watch(const std::string& directory);
+    void stop();
+
+    inline bool is_watching() { return fd >= 0; }
+
+    // Names of files created, written, moved or deleted since the last poll, without blocking.
+    // Returns false if events were lost and everything should be checked again
+    bool poll(std::vector<std::string>* changed);
+
+private:
+    int fd = -1;
+    int watch_descriptor = -1;
+};
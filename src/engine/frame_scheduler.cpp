@@ -0,0 +1,114 @@
+#include "frame_scheduler.hpp"
+
+#include "raylib.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+double FrameScheduler::now()
+{
+    std::chrono::duration<double> time = Clock::now() - start_time;
+    return time.count();
+}
+
+void FrameScheduler::wait_until(double time)
+{
+    double remaining = time - now();
+
+    if (remaining > SPIN_TIME)
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_TIME));
+
+    while (now() < time)
+        std::this_thread::yield();
+}
+
+//====================================================================
+
+// Without SUPPORT_CUSTOM_FRAME_CONTROL raylib's EndDrawing swaps, waits and polls input
+// too, and times the frame while at it. With it the frame time is never set
+void FrameScheduler::check_raylib()
+{
+#ifdef CELESTE_CUSTOM_FRAME_CONTROL
+    BeginDrawing();
+    EndDrawing();
+
+    if (GetFrameTime() > 0.0f)
+        TraceLog(LOG_FATAL, "Built for custom frame control, but raylib wasn't built with SUPPORT_CUSTOM_FRAME_CONTROL");
+#endif
+}
+
+void FrameScheduler::begin_frame(int target_fps)
+{
+#ifdef CELESTE_CUSTOM_FRAME_CONTROL
+    period = 1.0 / std::max(target_fps, 1);
+    double time = now();
+
+    // Fell behind or just started, aim for a full period from now
+    if (deadline < time || deadline - time > period * 2.0)
+        deadline = time + period;
+
+    // Start as late as the work allows, so the input it reads is as fresh as possible
+    wait_until(deadline - expected_work - MARGIN);
+
+    PollInputEvents();
+    sample_time = now();
+    work_start = sample_time;
+#else
+    // raylib polls input somewhere inside its own wait, when exactly isn't known
+    // so there's no input to present time to measure
+    work_start = now();
+#endif
+}
+
+void FrameScheduler::end_frame()
+{
+#ifdef CELESTE_CUSTOM_FRAME_CONTROL
+    SwapScreenBuffer();
+#endif
+
+    double present = now();
+    double work = present - work_start;
+
+#ifdef CELESTE_CUSTOM_FRAME_CONTROL
+    // Rises straight away with a slow frame, comes down slowly
+    expected_work = work > expected_work ? work : expected_work * 0.95 + work * 0.05;
+    deadline += period;
+#endif
+
+    if (last_present > 0.0) {
+        last_frame_time = present - last_present;
+
+        latencies[head] = is_pacing() ? present - sample_time : 0.0;
+        frame_times[head] = present - last_present;
+        work_times[head] = work;
+
+        head = (head + 1) % SAMPLES;
+        count = std::min(count + 1, SAMPLES);
+        update_stats();
+    }
+
+    last_present = present;
+}
+
+void FrameScheduler::update_stats()
+{
+    double latency = 0.0;
+    double frame_time = 0.0;
+    double work_time = 0.0;
+
+    for (int i = 0; i < count; i++) {
+        latency += latencies[i];
+        frame_time += frame_times[i];
+        work_time += work_times[i];
+    }
+
+    stats.latency = latency / count;
+    stats.frame_time = frame_time / count;
+    stats.work_time = work_time / count;
+
+    double variance = 0.0;
+    for (int i = 0; i < count; i++)
+        variance += (frame_times[i] - stats.frame_time) * (frame_times[i] - stats.frame_time);
+
+    stats.frame_time_deviation = std::sqrt(variance / count);
+}
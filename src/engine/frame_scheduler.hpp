@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+
+//====================================================================
+// Frame pacing
+//
+// Measures how long a frame's work takes, from sampling input to presenting,
+// and how evenly frames are spaced. Built with CELESTE_CUSTOM_FRAME_CONTROL
+// (the xmake option also asks for a raylib with SUPPORT_CUSTOM_FRAME_CONTROL)
+// it also paces frames itself. It waits until just enough time is left
+// before the frame deadline to do the work, polls input, and presents as
+// soon as the frame is drawn. The last stretch of the wait spins, sleeping
+// is too coarse to hit it. Otherwise raylib's SetTargetFPS does the waiting
+// and this only measures frame and work times. When raylib polls input isn't
+// known, so there is no latency.
+
+struct FrameStats {
+    // Only measured when pacing frames ourselves, zero otherwise
+    double latency = 0.0;
+    double frame_time = 0.0;
+    double frame_time_deviation = 0.0;
+    double work_time = 0.0;
+};
+
+class FrameScheduler {
+public:
+    // Call before sampling input, may wait for the right moment to start the frame
+    void begin_frame(int target_fps);
+    // Call once the frame has been drawn, presents it when pacing frames ourselves
+    void end_frame();
+
+    inline const FrameStats& get_stats() { return stats; }
+    // Present to present time of the last frame, raylib doesn't time frames it doesn't pace
+    inline float get_frame_time() { return last_frame_time; }
+
+    // Refuses to start with a raylib that still paces frames itself, call once after InitWindow
+    static void check_raylib();
+
+    static constexpr bool is_pacing()
+    {
+#ifdef CELESTE_CUSTOM_FRAME_CONTROL
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double now();
+    void wait_until(double time);
+    void update_stats();
+
+private:
+    // Stats are averaged over this many frames
+    static const int SAMPLES = 120;
+    // Extra time kept free in front of the deadline, on top of the expected work
+    static constexpr double MARGIN = 0.001;
+    // Closer than this to the wake up time, spin instead of sleeping
+    static constexpr double SPIN_TIME = 0.002;
+
+    Clock::time_point start_time = Clock::now();
+
+    double period = 0.0;
+    double deadline = 0.0;
+    double expected_work = 0.0;
+
+    double sample_time = 0.0;
+    double work_start = 0.0;
+    double last_present = 0.0;
+    float last_frame_time = 0.0f;
+
+    double latencies[SAMPLES] = { 0 };
+    double frame_times[SAMPLES] = { 0 };
+    double work_times[SAMPLES] = { 0 };
+    int head = 0;
+    int count = 0;
+
+    FrameStats stats;
+};
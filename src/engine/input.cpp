@@ -0,0 +1,188 @@
+#include "input.hpp"
+
+#include "raylib.h"
+#include <algorithm>
+
+ActionMap::ActionMap()
+{
+    bind_key(Action::Up, KEY_I);
+    bind_key(Action::Down, KEY_K);
+    bind_key(Action::Left, KEY_J);
+    bind_key(Action::Right, KEY_L);
+
+    bind_key(Action::Jump, KEY_SPACE);
+    bind_key(Action::Ability1, KEY_C);
+    bind_key(Action::Ability2, KEY_X);
+    bind_key(Action::Ability3, KEY_Z);
+    bind_key(Action::QuickSave, KEY_F6);
+    bind_key(Action::QuickLoad, KEY_F7);
+
+    bind_gamepad_button(Action::Up, GAMEPAD_BUTTON_LEFT_FACE_UP);
+    bind_gamepad_button(Action::Down, GAMEPAD_BUTTON_LEFT_FACE_DOWN);
+    bind_gamepad_button(Action::Left, GAMEPAD_BUTTON_LEFT_FACE_LEFT);
+    bind_gamepad_button(Action::Right, GAMEPAD_BUTTON_LEFT_FACE_RIGHT);
+
+    bind_gamepad_axis(Action::Up, GAMEPAD_AXIS_LEFT_Y, -1);
+    bind_gamepad_axis(Action::Down, GAMEPAD_AXIS_LEFT_Y, 1);
+    bind_gamepad_axis(Action::Left, GAMEPAD_AXIS_LEFT_X, -1);
+    bind_gamepad_axis(Action::Right, GAMEPAD_AXIS_LEFT_X, 1);
+
+    bind_gamepad_button(Action::Jump, GAMEPAD_BUTTON_RIGHT_FACE_DOWN);
+    bind_gamepad_button(Action::Ability1, GAMEPAD_BUTTON_RIGHT_FACE_LEFT);
+    bind_gamepad_button(Action::Ability2, GAMEPAD_BUTTON_RIGHT_FACE_RIGHT);
+    bind_gamepad_button(Action::Ability3, GAMEPAD_BUTTON_RIGHT_TRIGGER_1);
+}
+
+bool ActionMap::bind_key(Action action, int key)
+{
+    Bindings& binding = bindings[static_cast<int>(action)];
+    if (binding.key_count >= MAX_BINDINGS)
+        return false;
+
+    binding.keys[binding.key_count++] = key;
+    return true;
+}
+
+bool ActionMap::bind_gamepad_button(Action action, int button)
+{
+    Bindings& binding = bindings[static_cast<int>(action)];
+    if (binding.button_count >= MAX_BINDINGS)
+        return false;
+
+    binding.buttons[binding.button_count++] = button;
+    return true;
+}
+
+bool ActionMap::bind_gamepad_axis(Action action, int axis, int sign)
+{
+    Bindings& binding = bindings[static_cast<int>(action)];
+    if (binding.axis_count >= MAX_BINDINGS)
+        return false;
+
+    binding.axes[binding.axis_count] = axis;
+    binding.axis_signs[binding.axis_count] = sign < 0 ? -1 : 1;
+    binding.axis_count += 1;
+    return true;
+}
+
+void ActionMap::clear(Action action)
+{
+    bindings[static_cast<int>(action)] = Bindings();
+}
+
+InputSnapshot ActionMap::sample(int gamepad, const InputSnapshot& previous) const
+{
+    InputSnapshot result;
+    bool has_gamepad = IsGamepadAvailable(gamepad);
+
+    for (int i = 0; i < static_cast<int>(Action::Count); i++) {
+        const Bindings& binding = bindings[i];
+        uint32_t bit = InputSnapshot::bit(static_cast<Action>(i));
+
+        for (int k = 0; k < binding.key_count; k++) {
+            if (IsKeyDown(binding.keys[k]))
+                result.down |= bit;
+            if (IsKeyPressed(binding.keys[k]))
+                result.pressed |= bit;
+        }
+
+        if (!has_gamepad)
+            continue;
+
+        for (int b = 0; b < binding.button_count; b++) {
+            if (IsGamepadButtonDown(gamepad, binding.buttons[b]))
+                result.down |= bit;
+            if (IsGamepadButtonPressed(gamepad, binding.buttons[b]))
+                result.pressed |= bit;
+        }
+
+        for (int a = 0; a < binding.axis_count; a++) {
+            float movement = GetGamepadAxisMovement(gamepad, binding.axes[a]) * binding.axis_signs[a];
+            if (movement < AXIS_DEADZONE)
+                continue;
+
+            result.down |= bit;
+            if (!(previous.down & bit))
+                result.pressed |= bit;
+        }
+    }
+
+    return result;
+}
+
+//====================================================================
+
+// Devices are only polled once a frame, so a change could have happened any time
+// since the last sample. Stamping it with the earliest of those times hands it to
+// the first tick that could have seen it
+void Input::update(double time)
+{
+    double previous_time = sample_time;
+    uint32_t previous_down = snapshot.down;
+
+    previous_sample_time = sample_time;
+    sample_time = time;
+
+    if (!recorded.empty()) {
+        snapshot = recorded.front();
+        recorded.pop_front();
+    } else
+        snapshot = action_map.sample(gamepad, snapshot);
+
+    uint32_t changed = previous_down ^ snapshot.down;
+    uint32_t repeated = snapshot.pressed & ~changed;
+
+    for (int i = 0; i < static_cast<int>(Action::Count); i++) {
+        Action action = static_cast<Action>(i);
+        uint32_t bit = InputSnapshot::bit(action);
+
+        // Pressed without the down state changing, it went both ways within the frame
+        if (repeated & bit) {
+            bool down = (snapshot.down & bit) != 0;
+            push_event(previous_time, action, !down);
+            push_event(previous_time, action, down);
+        }
+
+        else if (changed & bit)
+            push_event(previous_time, action, (snapshot.down & bit) != 0);
+    }
+}
+
+void Input::push_event(double time, Action action, bool down)
+{
+    events.push_back({ time, action, down });
+
+    // Nothing is taking ticks, keep the state but forget the press
+    while (events.size() > MAX_EVENTS) {
+        InputEvent& event = events.front();
+        uint32_t bit = InputSnapshot::bit(event.action);
+        tick_down = event.down ? tick_down | bit : tick_down & ~bit;
+        events.pop_front();
+    }
+}
+
+void Input::begin_tick(double end_time)
+{
+    end_time = std::max(end_time, previous_sample_time);
+    tick_snapshot.pressed = 0;
+
+    while (!events.empty() && events.front().time <= end_time) {
+        InputEvent& event = events.front();
+        uint32_t bit = InputSnapshot::bit(event.action);
+
+        if (event.down) {
+            tick_down |= bit;
+            tick_snapshot.pressed |= bit;
+        } else
+            tick_down &= ~bit;
+
+        events.pop_front();
+    }
+
+    tick_snapshot.down = tick_down;
+}
+
+void Input::play(const InputSnapshot& frame)
+{
+    recorded.push_back(frame);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+//====================================================================
+// Per frame input
+//
+// Keyboard and gamepad are sampled once per frame into an InputSnapshot, a
+// pair of bitsets with one bit per action. The ActionMap says which keys,
+// gamepad buttons and stick directions set each action. Snapshots are plain
+// data, so recorded ones can be fed back in place of the devices.
+//
+// Changes between snapshots also become timestamped events. Fixed ticks take
+// the events that arrived before they end, so every press lands in exactly
+// one tick however the render and physics rates line up.
+
+enum class Action : uint8_t {
+    Up,
+    Down,
+    Left,
+    Right,
+    Jump,
+    Ability1,
+    Ability2,
+    Ability3,
+    QuickSave,
+    QuickLoad,
+    Count,
+};
+
+struct InputSnapshot {
+    uint32_t down = 0;
+    uint32_t pressed = 0;
+
+    static inline uint32_t bit(Action action) { return 1u << static_cast<int>(action); }
+
+    inline bool is_down(Action action) const { return (down & bit(action)) != 0; }
+    inline bool is_pressed(Action action) const { return (pressed & bit(action)) != 0; }
+};
+
+static_assert(static_cast<int>(Action::Count) <= 32, "InputSnapshot holds 32 actions");
+
+struct InputEvent {
+    double time;
+    Action action;
+    bool down;
+};
+
+//====================================================================
+
+class ActionMap {
+public:
+    ActionMap();
+
+    // False once the action has no room for more bindings
+    bool bind_key(Action action, int key);
+    bool bind_gamepad_button(Action action, int button);
+    // Stick direction, sign is -1 or 1
+    bool bind_gamepad_axis(Action action, int axis, int sign);
+    void clear(Action action);
+
+    // Stick directions have no pressed state of their own, they count as pressed when the action wasn't down before
+    InputSnapshot sample(int gamepad, const InputSnapshot& previous) const;
+
+private:
+    static const int MAX_BINDINGS = 4;
+    static constexpr float AXIS_DEADZONE = 0.5f;
+
+    struct Bindings {
+        int keys[MAX_BINDINGS];
+        int key_count = 0;
+
+        int buttons[MAX_BINDINGS];
+        int button_count = 0;
+
+        int axes[MAX_BINDINGS];
+        int axis_signs[MAX_BINDINGS];
+        int axis_count = 0;
+    };
+
+    Bindings bindings[static_cast<int>(Action::Count)];
+};
+
+//====================================================================
+
+class Input {
+public:
+    // Call once at the start of every frame with the current time
+    void update(double time);
+
+    // Call before every fixed tick with the time its input window ends at. Never ends
+    // before the previous sample, so whatever this frame polled reaches its first tick
+    void begin_tick(double end_time);
+
+    // This frame's state, for anything that runs once per frame
+    inline const InputSnapshot& get_snapshot() const { return snapshot; }
+    // State for the current fixed tick, pressed holds every press that arrived during it
+    inline const InputSnapshot& get_tick_snapshot() const { return tick_snapshot; }
+    inline double get_sample_time() const { return sample_time; }
+
+    inline ActionMap* get_action_map() { return &action_map; }
+
+    // Queued snapshots replace the devices, one per frame, until the queue runs dry
+    void play(const InputSnapshot& frame);
+    inline bool is_playing() const { return !recorded.empty(); }
+
+private:
+    void push_event(double time, Action action, bool down);
+
+private:
+    // Events waiting for a tick, past this the oldest lose their press
+    static const int MAX_EVENTS = 256;
+
+    ActionMap action_map;
+    InputSnapshot snapshot;
+    int gamepad = 0;
+    double sample_time = 0.0;
+    double previous_sample_time = 0.0;
+
+    std::deque<InputEvent> events;
+    uint32_t tick_down = 0;
+    InputSnapshot tick_snapshot;
+
+    std::deque<InputSnapshot> recorded;
+};
@@ -0,0 +1,164 @@
+#include "jobs.hpp"
+
+#include "raylib.h"
+#include <algorithm>
+
+// Index of the queue owned by the current thread, -1 for non-worker threads
+static thread_local int local_queue_index = -1;
+
+//====================================================================
+
+JobSystem::JobSystem() { }
+
+JobSystem::~JobSystem()
+{
+    shutdown();
+}
+
+void JobSystem::init(int thread_count)
+{
+    if (running)
+        return;
+
+    if (thread_count <= 0)
+        thread_count = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+    TraceLog(TraceLogLevel::LOG_INFO, "Starting job system with %d workers", thread_count);
+
+    running = true;
+
+    for (int i = 0; i < thread_count; i++)
+        queues.push_back(std::make_unique<WorkerQueue>());
+
+    for (int i = 0; i < thread_count; i++)
+        workers.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+void JobSystem::shutdown()
+{
+    if (!running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        running = false;
+    }
+    wake.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    workers.clear();
+    queues.clear();
+}
+
+//====================================================================
+
+void JobSystem::parallel_for(int count, int batch_size, const std::function<void(int, int)>& func)
+{
+    if (count <= 0)
+        return;
+
+    batch_size = std::max(batch_size, 1);
+
+    // Nothing to share the work with, run inline
+    if (workers.empty() || count <= batch_size) {
+        func(0, count);
+        return;
+    }
+
+    const int batches = (count + batch_size - 1) / batch_size;
+    std::atomic<int> remaining = batches;
+
+    // Spread batches over every queue so idle workers start with something to do
+    for (int batch = 0; batch < batches; batch++) {
+        int begin = batch * batch_size;
+        int end = std::min(begin + batch_size, count);
+
+        int queue_index = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        push(queue_index, { [&func, begin, end]() { func(begin, end); }, &remaining });
+    }
+
+    // Sync with workers about to sleep so the wake up can't be missed
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake.notify_all();
+
+    // Help out until our batches are done
+    int own_queue = local_queue_index >= 0 ? local_queue_index : 0;
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        Job job;
+        if (pop_or_steal(own_queue, &job))
+            run_job(&job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+//====================================================================
+
+void JobSystem::worker_loop(int index)
+{
+    local_queue_index = index;
+
+    while (true) {
+        Job job;
+        if (pop_or_steal(index, &job)) {
+            run_job(&job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake.wait(lock, [this]() { return !running || queued_jobs.load() > 0; });
+
+        if (!running)
+            return;
+    }
+}
+
+void JobSystem::push(int queue_index, Job job)
+{
+    WorkerQueue* queue = queues[queue_index].get();
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->jobs.push_back(std::move(job));
+    }
+
+    queued_jobs.fetch_add(1, std::memory_order_release);
+}
+
+bool JobSystem::pop_or_steal(int queue_index, Job* job)
+{
+    // Own queue first, newest job (still warm in cache)
+    {
+        WorkerQueue* queue = queues[queue_index].get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty()) {
+            *job = std::move(queue->jobs.back());
+            queue->jobs.pop_back();
+            queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest job from someone else
+    for (int i = 1; i < queues.size(); i++) {
+        WorkerQueue* queue = queues[(queue_index + i) % queues.size()].get();
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (!queue->jobs.empty()) {
+            *job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+            queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::run_job(Job* job)
+{
+    job->func();
+    job->remaining->fetch_sub(1, std::memory_order_release);
+}
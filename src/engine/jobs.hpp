@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//====================================================================
+// Small work-stealing job system
+//
+// Every worker owns a queue. Workers pop from the back of their own queue
+// and steal from the front of the others once it is empty. Threads that wait
+// on a batch of jobs help run them, so jobs can safely start more jobs.
+
+class JobSystem {
+public:
+    JobSystem();
+    ~JobSystem();
+
+    void init(int thread_count = 0);
+    void shutdown();
+
+    // Run func(begin, end) over [0, count) in batches of batch_size.
+    // Blocks until every batch has finished.
+    void parallel_for(int count, int batch_size, const std::function<void(int, int)>& func);
+
+    inline int get_worker_count() { return workers.size(); }
+
+private:
+    struct Job {
+        std::function<void()> func;
+        std::atomic<int>* remaining;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void worker_loop(int index);
+    void push(int queue_index, Job job);
+    bool pop_or_steal(int queue_index, Job* job);
+    void run_job(Job* job);
+
+private:
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<int> queued_jobs = 0;
+    std::atomic<bool> running = false;
+    std::atomic<int> next_queue = 0;
+};
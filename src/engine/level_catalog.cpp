@@ -0,0 +1,439 @@
+#include "level_catalog.hpp"
+
+#include "../game/player.hpp"
+#include "asset_pack.hpp"
+#include "entity.hpp"
+#include "save.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+
+static const char* INDEX_HEADER = "celestelike-level-index 2";
+
+//====================================================================
+
+LevelCatalog::~LevelCatalog()
+{
+    close();
+}
+
+void LevelCatalog::open(const std::string& new_directory, const AssetPack* new_pack, const std::string& index_name)
+{
+    close();
+
+    directory = new_directory;
+    pack = new_pack && new_pack->is_open() ? new_pack : nullptr;
+    index_path = directory + "/" + index_name;
+
+    load_index();
+
+    running = true;
+    worker = std::thread(&LevelCatalog::worker_loop, this);
+
+    if (!watcher.watch(directory))
+        TraceLog(LOG_INFO, "Level catalog - no file watcher, checking for changes every %.0f seconds", SCAN_INTERVAL);
+
+    // Catch anything that changed while the game wasn't running
+    rescan();
+}
+
+void LevelCatalog::close()
+{
+    watcher.stop();
+
+    if (running) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            requests.clear();
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    // Whatever finished still goes into the index
+    take_results();
+    reading.clear();
+
+    if (index_dirty)
+        save_index();
+
+    directory.clear();
+    levels.clear();
+    pending.clear();
+    pending_set.clear();
+    generation += 1;
+}
+
+void LevelCatalog::update()
+{
+    if (directory.empty())
+        return;
+
+    if (watcher.is_watching()) {
+        changed.clear();
+        bool complete = watcher.poll(&changed);
+
+        for (const std::string& file_name : changed) {
+            if (is_level_file(file_name.c_str()))
+                mark_changed(file_name);
+        }
+
+        if (!complete)
+            rescan();
+    }
+
+    else if (GetTime() - last_scan_time >= SCAN_INTERVAL)
+        rescan();
+
+    for (int i = 0; i < FILES_PER_UPDATE && !pending.empty(); i++) {
+        std::string file_name = std::move(pending.front());
+        pending.pop_front();
+        pending_set.erase(file_name);
+
+        refresh_file(file_name);
+    }
+
+    take_results();
+
+    if (pending.empty() && reading.empty() && index_dirty)
+        save_index();
+}
+
+void LevelCatalog::rescan()
+{
+    last_scan_time = GetTime();
+
+    std::unordered_set<std::string> found;
+
+    FilePathList files = LoadDirectoryFiles(directory.c_str());
+    for (unsigned int i = 0; i < files.count; i++) {
+        const char* file_name = GetFileName(files.paths[i]);
+        if (!is_level_file(file_name))
+            continue;
+
+        found.insert(file_name);
+
+        auto it = find(file_name);
+        if (it == levels.end() || it->modified != GetFileModTime(files.paths[i]))
+            mark_changed(file_name);
+    }
+    UnloadDirectoryFiles(files);
+
+    // Shipped levels that nothing on disk overrides
+    if (pack) {
+        long pack_modified = GetFileModTime(pack->get_path().c_str());
+
+        pack_names.clear();
+        pack->get_names(&pack_names);
+
+        for (const std::string& name : pack_names) {
+            if (!is_level_file(name.c_str()) || !found.insert(name).second)
+                continue;
+
+            auto it = find(name);
+            if (it == levels.end() || !it->packed || it->modified != pack_modified)
+                mark_changed(name);
+        }
+    }
+
+    // Deleted files
+    for (LevelInfo& level : levels) {
+        if (!found.count(level.file_name))
+            mark_changed(level.file_name);
+    }
+}
+
+void LevelCatalog::mark_changed(const std::string& file_name)
+{
+    if (pending_set.insert(file_name).second)
+        pending.push_back(file_name);
+}
+
+// When the watcher reports the same write later, the modification time matches
+// and refresh_file leaves it alone
+void LevelCatalog::mark_saved(const std::string& file_name, LevelInfo info)
+{
+    if (directory.empty())
+        return;
+
+    std::string path = directory + "/" + file_name;
+    if (!FileExists(path.c_str()))
+        return;
+
+    info.file_name = file_name;
+    info.modified = GetFileModTime(path.c_str());
+    info.valid = true;
+
+    // An older read still on the worker would overwrite this
+    reading.erase(file_name);
+    store(std::move(info));
+}
+
+static bool has_extension(const char* file_name, const char* extension)
+{
+    size_t length = strlen(file_name);
+    size_t extension_length = strlen(extension);
+
+    return length > extension_length && strcmp(file_name + length - extension_length, extension) == 0;
+}
+
+// Levels saved before the chunked format are still .json
+bool LevelCatalog::is_level_file(const char* file_name)
+{
+    const char* prefix = "level-";
+
+    return strncmp(file_name, prefix, strlen(prefix)) == 0
+        && (has_extension(file_name, ".lvl") || has_extension(file_name, ".json"));
+}
+
+//====================================================================
+
+std::vector<LevelInfo>::iterator LevelCatalog::find(const std::string& file_name)
+{
+    auto it = std::lower_bound(levels.begin(), levels.end(), file_name,
+        [](const LevelInfo& level, const std::string& name) { return level.file_name < name; });
+
+    if (it != levels.end() && it->file_name == file_name)
+        return it;
+
+    return levels.end();
+}
+
+void LevelCatalog::refresh_file(const std::string& file_name)
+{
+    std::string path = directory + "/" + file_name;
+    auto it = find(file_name);
+
+    bool on_disk = FileExists(path.c_str());
+    bool packed = !on_disk && pack && pack->contains(file_name);
+
+    if (!on_disk && !packed) {
+        reading.erase(file_name);
+
+        if (it != levels.end()) {
+            levels.erase(it);
+            generation += 1;
+            index_dirty = true;
+        }
+        return;
+    }
+
+    long modified = GetFileModTime(packed ? pack->get_path().c_str() : path.c_str());
+    if (it != levels.end() && it->modified == modified && it->packed == packed)
+        return;
+
+    auto in_flight = reading.find(file_name);
+    if (in_flight != reading.end() && in_flight->second == modified)
+        return;
+
+    reading[file_name] = modified;
+
+    LevelInfo info;
+    info.file_name = file_name;
+    info.modified = modified;
+    info.packed = packed;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back(std::move(info));
+    }
+    wake.notify_one();
+}
+
+void LevelCatalog::take_results()
+{
+    finished.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(results);
+    }
+
+    for (LevelInfo& info : finished) {
+        auto it = reading.find(info.file_name);
+        if (it == reading.end() || it->second != info.modified)
+            continue;
+
+        reading.erase(it);
+        store(std::move(info));
+    }
+}
+
+void LevelCatalog::store(LevelInfo info)
+{
+    auto it = find(info.file_name);
+
+    if (it != levels.end())
+        *it = std::move(info);
+    else {
+        auto position = std::lower_bound(levels.begin(), levels.end(), info.file_name,
+            [](const LevelInfo& level, const std::string& name) { return level.file_name < name; });
+        levels.insert(position, std::move(info));
+    }
+
+    generation += 1;
+    index_dirty = true;
+}
+
+//====================================================================
+// Worker thread
+
+void LevelCatalog::worker_loop()
+{
+    while (true) {
+        LevelInfo info;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !running || !requests.empty(); });
+
+            if (!running)
+                return;
+
+            info = std::move(requests.front());
+            requests.pop_front();
+        }
+
+        info.valid = read_info(&info);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(std::move(info));
+    }
+}
+
+bool LevelCatalog::read_info(LevelInfo* info) const
+{
+    SaveData data;
+
+    if (info->packed) {
+        AssetView view;
+        std::vector<unsigned char> storage;
+
+        if (!pack->get(info->file_name, &view, &storage)
+            || !read_save_data(info->file_name, std::string_view((const char*)view.data, view.size), &data))
+            return false;
+    }
+
+    else if (!read_save_file(directory + "/" + info->file_name, &data))
+        return false;
+
+    summarize(data, info);
+    return true;
+}
+
+// The player's size depends on its character, so it only adds its position to the bounds
+void LevelCatalog::summarize(const SaveData& data, LevelInfo* info)
+{
+    info->actors = 0;
+    info->solids = 0;
+    info->bounds = { 0 };
+
+    float min_x = FLT_MAX;
+    float min_y = FLT_MAX;
+    float max_x = -FLT_MAX;
+    float max_y = -FLT_MAX;
+
+    for (const std::unique_ptr<RawEntity>& raw : data.entities) {
+        Rectangle bounds;
+
+        if (RawSolid* solid = dynamic_cast<RawSolid*>(raw.get())) {
+            info->solids += 1;
+            bounds = {
+                (float)(solid->x - solid->half_width),
+                (float)(solid->y - solid->half_height),
+                (float)(solid->half_width * 2),
+                (float)(solid->half_height * 2),
+            };
+        } else if (dynamic_cast<RawPlayer*>(raw.get())) {
+            info->actors += 1;
+            bounds = { (float)raw->x, (float)raw->y, 0.0f, 0.0f };
+        } else
+            continue;
+
+        min_x = std::min(min_x, bounds.x);
+        min_y = std::min(min_y, bounds.y);
+        max_x = std::max(max_x, bounds.x + bounds.width);
+        max_y = std::max(max_y, bounds.y + bounds.height);
+    }
+
+    if (min_x <= max_x)
+        info->bounds = { min_x, min_y, max_x - min_x, max_y - min_y };
+}
+
+//====================================================================
+// Index file, one tab separated line per level
+
+bool LevelCatalog::load_index()
+{
+    levels.clear();
+
+    FILE* file = fopen(index_path.c_str(), "r");
+    if (!file)
+        return false;
+
+    char line[512];
+    if (!fgets(line, sizeof(line), file) || strncmp(line, INDEX_HEADER, strlen(INDEX_HEADER)) != 0) {
+        fclose(file);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        char name[256];
+        int valid;
+        int packed;
+        LevelInfo info;
+
+        int read = sscanf(
+            line,
+            "%255[^\t]\t%ld\t%d\t%d\t%d\t%d\t%f\t%f\t%f\t%f",
+            name, &info.modified, &valid, &packed, &info.actors, &info.solids,
+            &info.bounds.x, &info.bounds.y, &info.bounds.width, &info.bounds.height);
+
+        if (read != 10 || !is_level_file(name))
+            continue;
+
+        info.file_name = name;
+        info.valid = valid != 0;
+        info.packed = packed != 0;
+        levels.push_back(std::move(info));
+    }
+
+    fclose(file);
+
+    std::sort(levels.begin(), levels.end(),
+        [](const LevelInfo& a, const LevelInfo& b) { return a.file_name < b.file_name; });
+
+    generation += 1;
+    return true;
+}
+
+void LevelCatalog::save_index()
+{
+    index_dirty = false;
+
+    std::string temp_path = index_path + ".tmp";
+    FILE* file = fopen(temp_path.c_str(), "w");
+    if (!file) {
+        TraceLog(LOG_WARNING, "Could not write level index '%s'", index_path.c_str());
+        return;
+    }
+
+    fprintf(file, "%s\n", INDEX_HEADER);
+
+    for (LevelInfo& level : levels) {
+        fprintf(
+            file,
+            "%s\t%ld\t%d\t%d\t%d\t%d\t%f\t%f\t%f\t%f\n",
+            level.file_name.c_str(), level.modified, (int)level.valid, (int)level.packed, level.actors, level.solids,
+            level.bounds.x, level.bounds.y, level.bounds.width, level.bounds.height);
+    }
+
+    fclose(file);
+
+    if (std::rename(temp_path.c_str(), index_path.c_str()) != 0) {
+        std::remove(index_path.c_str());
+        std::rename(temp_path.c_str(), index_path.c_str());
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "file_watcher.hpp"
+#include "raylib.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//====================================================================
+// Index of the level files in a directory
+//
+// Metadata for every level is kept in an index file so it is ready as soon
+// as the game starts. Changed files are found through a FileWatcher (or by
+// checking modification times every few seconds without one) and re-read on
+// a worker thread, so even a directory with thousands of levels doesn't stall
+// a frame. Our own saves hand their info over directly and aren't read back.
+// Levels shipped in the asset pack are listed too, unless a file on disk
+// with the same name overrides them.
+
+struct LevelInfo {
+    std::string file_name;
+    long modified = 0;
+
+    // False if the file couldn't be read, the counts and bounds are empty
+    bool valid = false;
+    // Only in the asset pack, modified is the pack's
+    bool packed = false;
+    int actors = 0;
+    int solids = 0;
+    Rectangle bounds = { 0 };
+};
+
+class LevelCatalog {
+public:
+    LevelCatalog() { }
+    ~LevelCatalog();
+
+    void open(const std::string& directory, const class AssetPack* pack = nullptr, const std::string& index_name = "levels.index");
+    void close();
+
+    // Call every frame
+    void update();
+
+    // Check every file in the directory again
+    void rescan();
+
+    // Re-read a level without waiting for the watcher to notice
+    void mark_changed(const std::string& file_name);
+    // A level we just wrote, info comes from summarize on what was written
+    void mark_saved(const std::string& file_name, LevelInfo info);
+
+    // Sorted by file name
+    inline const std::vector<LevelInfo>& get_levels() { return levels; }
+    inline int get_pending_count() { return pending.size() + reading.size(); }
+
+    // Changes every time a level is added, removed or updated
+    inline unsigned int get_generation() { return generation; }
+
+    static bool is_level_file(const char* file_name);
+
+    // Counts and bounds straight from the raw entities, nothing is constructed.
+    // Safe to call from any thread
+    static void summarize(const struct SaveData& data, LevelInfo* info);
+
+private:
+    bool load_index();
+    void save_index();
+
+    void refresh_file(const std::string& file_name);
+    void store(LevelInfo info);
+    void take_results();
+
+    // Worker thread
+    void worker_loop();
+    bool read_info(LevelInfo* info) const;
+
+    std::vector<LevelInfo>::iterator find(const std::string& file_name);
+
+private:
+    static const int FILES_PER_UPDATE = 8;
+    static constexpr double SCAN_INTERVAL = 2.0;
+
+    std::string directory;
+    std::string index_path;
+    const class AssetPack* pack = nullptr;
+    std::vector<std::string> pack_names;
+
+    std::vector<LevelInfo> levels;
+    unsigned int generation = 0;
+    bool index_dirty = false;
+
+    std::deque<std::string> pending;
+    std::unordered_set<std::string> pending_set;
+
+    // Modification time each file is being read at. A result only counts if it's
+    // still the one wanted, a newer read or a deletion replaces it
+    std::unordered_map<std::string, long> reading;
+
+    std::thread worker;
+    bool running = false;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<LevelInfo> requests;
+    std::vector<LevelInfo> results;
+    std::vector<LevelInfo> finished;
+
+    FileWatcher watcher;
+    std::vector<std::string> changed;
+    double last_scan_time = 0.0;
+};
@@ -0,0 +1,151 @@
+#include "level_journal.hpp"
+
+#include "raylib.h"
+#include "save.hpp"
+#include "save_worker.hpp"
+
+//====================================================================
+
+LevelJournal::~LevelJournal()
+{
+    close();
+}
+
+void LevelJournal::open(const std::string& new_level_file, bool truncate)
+{
+    close();
+
+    level_file = new_level_file;
+    journal_file = level_file + ".journal";
+    old_journal_file = level_file + ".journal.old";
+
+    if (truncate) {
+        std::remove(old_journal_file.c_str());
+        std::remove(journal_file.c_str());
+    }
+
+    file = fopen(journal_file.c_str(), "a");
+    edit_count = 0;
+
+    if (!file)
+        TraceLog(LOG_WARNING, "Could not open level journal '%s'", journal_file.c_str());
+}
+
+void LevelJournal::close()
+{
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void LevelJournal::append(const TileEdit& edit)
+{
+    if (!file)
+        return;
+
+    fprintf(file, "%c %d %d %d %d\n", edit.added ? '+' : '-', edit.x, edit.y, edit.half_width, edit.half_height);
+    edit_count += 1;
+}
+
+void LevelJournal::flush()
+{
+    if (file)
+        fflush(file);
+}
+
+//====================================================================
+// Compaction
+
+void LevelJournal::compact(std::unique_ptr<SaveData> snapshot, SaveWorker* worker, bool is_autosave)
+{
+    if (!file)
+        return;
+
+    // Claimed before rotating, so an earlier compaction finishing meanwhile
+    // can't delete the .old journal this one is about to append to
+    int compaction = ++compactions_queued;
+    compactions_pending += 1;
+
+    // Edits from now on go to the fresh journal
+    rotate();
+
+    std::string old = old_journal_file;
+
+    worker->queue(level_file, std::move(snapshot), is_autosave, [this, compaction, old](bool success) {
+        if (success && compaction == compactions_queued)
+            std::remove(old.c_str());
+
+        compactions_pending -= 1;
+    });
+}
+
+// journal -> journal.old, appended if an earlier compaction never finished
+void LevelJournal::rotate()
+{
+    fclose(file);
+    file = nullptr;
+
+    FILE* old = fopen(old_journal_file.c_str(), "r");
+    if (!old)
+        std::rename(journal_file.c_str(), old_journal_file.c_str());
+
+    else {
+        fclose(old);
+
+        FILE* from = fopen(journal_file.c_str(), "r");
+        FILE* to = fopen(old_journal_file.c_str(), "a");
+
+        if (from && to) {
+            char buffer[4096];
+            size_t read;
+            while ((read = fread(buffer, 1, sizeof(buffer), from)) > 0)
+                fwrite(buffer, 1, read, to);
+        }
+
+        if (from)
+            fclose(from);
+        if (to)
+            fclose(to);
+
+        std::remove(journal_file.c_str());
+    }
+
+    file = fopen(journal_file.c_str(), "a");
+    edit_count = 0;
+}
+
+//====================================================================
+// Replay
+
+bool LevelJournal::read(const std::string& level_file, std::vector<TileEdit>* edits)
+{
+    bool found = read_file(level_file + ".journal.old", edits);
+    found |= read_file(level_file + ".journal", edits);
+    return found;
+}
+
+bool LevelJournal::read_file(const std::string& journal_file, std::vector<TileEdit>* edits)
+{
+    FILE* journal = fopen(journal_file.c_str(), "r");
+    if (!journal)
+        return false;
+
+    char line[128];
+    while (fgets(line, sizeof(line), journal)) {
+        char type;
+        TileEdit edit;
+
+        // Skips anything half written
+        if (sscanf(line, "%c %d %d %d %d", &type, &edit.x, &edit.y, &edit.half_width, &edit.half_height) != 5)
+            continue;
+        if (type != '+' && type != '-')
+            continue;
+
+        edit.added = type == '+';
+        edits->push_back(edit);
+    }
+
+    fclose(journal);
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "edit_history.hpp"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+//====================================================================
+// Append-only journal of editor changes made since the level was last saved
+//
+// Lives next to the level file as "<level>.journal", one tile edit per line.
+// Compacting moves the journal aside and queues a snapshot of the world to be
+// written over the level file. Replaying is idempotent, so a journal left
+// behind by an interrupted compaction is safe to apply again.
+
+class LevelJournal {
+public:
+    LevelJournal() { }
+    ~LevelJournal();
+
+    // Start journaling for a level file, truncate when the level file was just written
+    void open(const std::string& level_file, bool truncate);
+    void close();
+
+    void append(const TileEdit& edit);
+    void flush();
+
+    // Queues the snapshot of the world on the save worker, the moved journal goes once it's written
+    void compact(std::unique_ptr<struct SaveData> snapshot, class SaveWorker* worker, bool is_autosave);
+
+    inline bool is_open() { return file != nullptr; }
+    inline bool is_compacting() { return compactions_pending > 0; }
+    inline int get_edit_count() { return edit_count; }
+    inline const std::string& get_level_file() { return level_file; }
+
+    // Every edit recorded for a level file, oldest first
+    static bool read(const std::string& level_file, std::vector<TileEdit>* edits);
+
+private:
+    static bool read_file(const std::string& journal_file, std::vector<TileEdit>* edits);
+    void rotate();
+
+private:
+    std::string level_file;
+    std::string journal_file;
+    std::string old_journal_file;
+
+    FILE* file = nullptr;
+    int edit_count = 0;
+
+    // Only the latest compaction may remove the moved journal, earlier ones don't cover all of it
+    std::atomic<int> compactions_queued = 0;
+    std::atomic<int> compactions_pending = 0;
+};
@@ -0,0 +1,201 @@
+#include "level_thumbnails.hpp"
+
+#include "entity.hpp"
+#include "level_catalog.hpp"
+#include "save.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <filesystem>
+
+//====================================================================
+
+LevelThumbnails::~LevelThumbnails()
+{
+    stop();
+}
+
+void LevelThumbnails::start(const AssetPack* new_pack, const std::string& new_cache_directory)
+{
+    if (running)
+        return;
+
+    pack = new_pack;
+    cache_directory = new_cache_directory;
+    running = true;
+    worker = std::thread(&LevelThumbnails::worker_loop, this);
+}
+
+void LevelThumbnails::stop()
+{
+    if (!running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        requests.clear();
+    }
+    wake.notify_all();
+    worker.join();
+
+    for (Result& result : results)
+        UnloadImage(result.image);
+    results.clear();
+
+    for (auto& [file_name, entry] : entries)
+        UnloadTexture(entry.texture);
+    entries.clear();
+}
+
+void LevelThumbnails::update()
+{
+    finished.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(results);
+    }
+
+    for (Result& result : finished) {
+        // Unreadable levels keep their (empty) entry so they aren't asked for again
+        if (!result.image.data)
+            continue;
+
+        Entry& entry = entries[result.file_name];
+        UnloadTexture(entry.texture);
+
+        entry.texture = LoadTextureFromImage(result.image);
+        entry.modified = result.modified;
+        UnloadImage(result.image);
+    }
+}
+
+Texture2D* LevelThumbnails::get(const LevelInfo& level)
+{
+    Entry& entry = entries[level.file_name];
+
+    if (entry.modified != level.modified && entry.requested != level.modified && running) {
+        entry.requested = level.modified;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back({ level.file_name, level.modified });
+        }
+        wake.notify_one();
+    }
+
+    return entry.texture.id != 0 ? &entry.texture : nullptr;
+}
+
+//====================================================================
+// Worker thread
+
+void LevelThumbnails::worker_loop()
+{
+    while (true) {
+        Request request;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !running || !requests.empty(); });
+            if (!running)
+                return;
+
+            // Newest first, those are the rows on screen right now
+            request = std::move(requests.back());
+            requests.pop_back();
+        }
+
+        Image image = build(request);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back({ request.file_name, request.modified, image });
+    }
+}
+
+std::string LevelThumbnails::get_cache_path(const Request& request)
+{
+    return cache_directory + "/" + request.file_name + "-" + std::to_string(request.modified) + ".png";
+}
+
+// Thumbnails of older versions of the level
+void LevelThumbnails::remove_stale(const Request& request)
+{
+    std::error_code error;
+    std::string prefix = request.file_name + "-";
+
+    for (auto& file : std::filesystem::directory_iterator(cache_directory, error)) {
+        std::string name = file.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) == 0)
+            std::filesystem::remove(file.path(), error);
+    }
+}
+
+Image LevelThumbnails::build(const Request& request)
+{
+    std::string cache_path = get_cache_path(request);
+
+    if (FileExists(cache_path.c_str())) {
+        Image image = LoadImage(cache_path.c_str());
+        if (image.data)
+            return image;
+    }
+
+    SaveData data;
+    if (!read_level(request.file_name, &data, pack))
+        return Image { 0 };
+
+    // Bounds of everything, actors only count as a point
+    float min_x = FLT_MAX;
+    float min_y = FLT_MAX;
+    float max_x = -FLT_MAX;
+    float max_y = -FLT_MAX;
+
+    for (std::unique_ptr<RawEntity>& raw : data.entities) {
+        float half_width = 0.0f;
+        float half_height = 0.0f;
+
+        if (RawSolid* solid = dynamic_cast<RawSolid*>(raw.get())) {
+            half_width = solid->half_width;
+            half_height = solid->half_height;
+        }
+
+        min_x = std::min(min_x, raw->x - half_width);
+        min_y = std::min(min_y, raw->y - half_height);
+        max_x = std::max(max_x, raw->x + half_width);
+        max_y = std::max(max_y, raw->y + half_height);
+    }
+
+    Image image = GenImageColor(SIZE, SIZE, RAYWHITE);
+
+    if (min_x <= max_x) {
+        float scale = (SIZE - 2) / std::max({ max_x - min_x, max_y - min_y, 1.0f });
+
+        // Centre the level in the square
+        float offset_x = (SIZE - (max_x - min_x) * scale) / 2.0f;
+        float offset_y = (SIZE - (max_y - min_y) * scale) / 2.0f;
+
+        for (std::unique_ptr<RawEntity>& raw : data.entities) {
+            RawSolid* solid = dynamic_cast<RawSolid*>(raw.get());
+
+            float half_width = solid ? solid->half_width : 1.0f / scale;
+            float half_height = solid ? solid->half_height : 1.0f / scale;
+
+            int x = (int)(offset_x + (raw->x - half_width - min_x) * scale);
+            int y = (int)(offset_y + (raw->y - half_height - min_y) * scale);
+            int width = std::max(1, (int)(half_width * 2.0f * scale));
+            int height = std::max(1, (int)(half_height * 2.0f * scale));
+
+            ImageDrawRectangle(&image, x, y, width, height, solid ? DARKGRAY : RED);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(cache_directory, error);
+    remove_stale(request);
+
+    if (!ExportImage(image, cache_path.c_str()))
+        TraceLog(LOG_WARNING, "Could not cache level thumbnail '%s'", cache_path.c_str());
+
+    return image;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "raylib.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//====================================================================
+// Level previews for the level menu
+//
+// A background thread reads the level file (or its entry in the asset pack)
+// and rasterizes its solids into an Image on the CPU. Images are cached on
+// disk by file name and modification time, so only new or changed levels are
+// ever read. Textures are created on the main thread in update().
+
+class LevelThumbnails {
+public:
+    static const int SIZE = 64;
+
+    LevelThumbnails() { }
+    ~LevelThumbnails();
+
+    void start(const class AssetPack* pack, const std::string& cache_directory = ".thumbs");
+    void stop();
+
+    // Main thread only
+    void update();
+
+    // Asks for the thumbnail if it isn't ready, nullptr until then. An outdated one is
+    // returned while the new one is made
+    Texture2D* get(const struct LevelInfo& level);
+
+private:
+    struct Request {
+        std::string file_name;
+        long modified;
+    };
+
+    struct Result {
+        std::string file_name;
+        long modified;
+        Image image;
+    };
+
+    struct Entry {
+        Texture2D texture = { 0 };
+        long modified = -1;
+        long requested = -1;
+    };
+
+    void worker_loop();
+    Image build(const Request& request);
+    std::string get_cache_path(const Request& request);
+    void remove_stale(const Request& request);
+
+private:
+    std::string cache_directory;
+    const class AssetPack* pack = nullptr;
+    std::unordered_map<std::string, Entry> entries;
+
+    std::thread worker;
+    bool running = false;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Request> requests;
+    std::vector<Result> results;
+    std::vector<Result> finished;
+};
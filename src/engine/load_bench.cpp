@@ -0,0 +1,113 @@
+#include "load_bench.hpp"
+
+#include "../defs.hpp"
+#include "entity.hpp"
+#include "jobs.hpp"
+#include "raylib.h"
+#include "save.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char* BENCH_LEVEL = "bench-level.lvl";
+static const int BENCH_LEVEL_SIZE = 512;
+
+static bool generate_level(const char* file_name)
+{
+    SaveData data;
+    data.version = "bench";
+
+    int half_width = TILE_WIDTH / 2;
+    int half_height = TILE_HEIGHT / 2;
+
+    for (int y = 0; y < BENCH_LEVEL_SIZE; y++) {
+        for (int x = 0; x < BENCH_LEVEL_SIZE; x++)
+            data.entities.push_back(std::make_unique<RawSolid>(
+                x * TILE_WIDTH + half_width, y * TILE_HEIGHT + half_height, half_width, half_height));
+    }
+
+    printf("Generating %s with %d solids\n", file_name, BENCH_LEVEL_SIZE * BENCH_LEVEL_SIZE);
+    return write_save_file(file_name, &data);
+}
+
+// Same steps as World::load_level, minus handing the entities to a world
+static double time_load(const char* file_name, JobSystem* jobs)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    SaveData data;
+    if (!read_save_file(file_name, &data, jobs))
+        return -1.0;
+
+    std::vector<Entity*> loaded(data.entities.size());
+    auto build = [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            loaded[i] = data.entities[i]->ToEntity().release();
+    };
+
+    if (jobs)
+        jobs->parallel_for(loaded.size(), 1024, build);
+    else
+        build(0, loaded.size());
+
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    for (Entity* entity : loaded)
+        delete entity;
+
+    return time.count();
+}
+
+int run_load_benchmark(const char* file_name, int runs)
+{
+    SetTraceLogLevel(LOG_WARNING);
+
+    if (!file_name) {
+        file_name = BENCH_LEVEL;
+        if (!FileExists(file_name) && !generate_level(file_name)) {
+            printf("Could not write %s\n", file_name);
+            return 1;
+        }
+    }
+
+    runs = std::max(runs, 1);
+    int max_workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+    printf("Loading %s, best of %d runs\n", file_name, runs);
+
+    double serial_time = 0.0;
+
+    // 0 workers is the plain single threaded path
+    for (int workers = 0;; workers = std::min(std::max(workers * 2, 1), max_workers)) {
+        JobSystem jobs;
+        if (workers > 0)
+            jobs.init(workers);
+
+        double best = DBL_MAX;
+        for (int run = 0; run < runs; run++) {
+            double time = time_load(file_name, workers > 0 ? &jobs : nullptr);
+            if (time < 0.0) {
+                printf("Could not load %s\n", file_name);
+                return 1;
+            }
+
+            best = std::min(best, time);
+        }
+
+        jobs.shutdown();
+
+        if (workers == 0)
+            serial_time = best;
+
+        printf("  %2d workers  %9.2fms  x%.2f\n", workers, best * 1000.0, serial_time / best);
+
+        if (workers >= max_workers)
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+//====================================================================
+// Level load benchmark
+//
+// Times decoding a level and building its entities with different numbers
+// of job system workers. Without a file, a large generated tile level is used.
+
+int run_load_benchmark(const char* file_name, int runs);
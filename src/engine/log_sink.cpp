@@ -0,0 +1,242 @@
+#include "log_sink.hpp"
+
+#include <chrono>
+#include <cstdlib>
+
+// raylib's callback has no user pointer
+static LogSink* active_sink = nullptr;
+
+static const char* level_name(int level)
+{
+    switch (level) {
+    case LOG_TRACE:
+        return "TRACE";
+    case LOG_DEBUG:
+        return "DEBUG";
+    case LOG_INFO:
+        return "INFO";
+    case LOG_WARNING:
+        return "WARNING";
+    case LOG_ERROR:
+        return "ERROR";
+    case LOG_FATAL:
+        return "FATAL";
+    default:
+        return "LOG";
+    }
+}
+
+//====================================================================
+
+LogSink::LogSink()
+{
+    for (int i = 0; i <= LOG_NONE; i++) {
+        sent[i] = 0;
+        suppressed[i] = 0;
+        rate_limit[i] = 0;
+    }
+
+    rate_limit[LOG_TRACE] = 200;
+    rate_limit[LOG_DEBUG] = 200;
+    rate_limit[LOG_INFO] = 500;
+}
+
+LogSink::~LogSink()
+{
+    stop();
+}
+
+void LogSink::start(const char* new_file_name, long new_max_file_size, int new_max_files)
+{
+    if (running)
+        return;
+
+    records = std::make_unique<RecordRing>();
+    start_time = std::chrono::steady_clock::now();
+
+    file_name = new_file_name;
+    max_file_size = new_max_file_size;
+    max_files = new_max_files;
+    open_file();
+
+    running = true;
+    writer = std::thread(&LogSink::writer_loop, this);
+
+    active_sink = this;
+    SetTraceLogCallback(&LogSink::trace_callback);
+}
+
+void LogSink::stop()
+{
+    if (!running)
+        return;
+
+    SetTraceLogCallback(nullptr);
+    active_sink = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        running = false;
+    }
+    wake.notify_all();
+    writer.join();
+
+    // Anything logged while the writer was finishing up
+    std::lock_guard<std::mutex> lock(file_mutex);
+    drain();
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void LogSink::set_rate_limit(int level, int per_second)
+{
+    if (level < 0 || level > LOG_NONE)
+        return;
+
+    rate_limit[level] = per_second;
+}
+
+//====================================================================
+// Producer side, runs on whichever thread called TraceLog
+
+void LogSink::trace_callback(int level, const char* text, va_list args)
+{
+    if (active_sink)
+        active_sink->push(level, text, args);
+}
+
+void LogSink::push(int level, const char* text, va_list args)
+{
+    if (level < 0 || level > LOG_NONE)
+        level = LOG_INFO;
+
+    int limit = rate_limit[level];
+    if (limit > 0 && sent[level].fetch_add(1, std::memory_order_relaxed) >= limit) {
+        suppressed[level].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    records->push_v(level, text, args);
+
+    // With a callback set raylib no longer exits on fatal messages, so get the
+    // message on disk and exit the way it would have
+    if (level == LOG_FATAL) {
+        {
+            std::lock_guard<std::mutex> lock(file_mutex);
+            drain();
+        }
+        exit(EXIT_FAILURE);
+    }
+}
+
+//====================================================================
+// Writer thread
+
+void LogSink::writer_loop()
+{
+    auto window_start = std::chrono::steady_clock::now();
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(10), [this]() { return !running; });
+            if (!running)
+                return;
+        }
+
+        std::lock_guard<std::mutex> lock(file_mutex);
+        drain();
+
+        // Start a new rate limit window every second
+        auto now = std::chrono::steady_clock::now();
+        if (now - window_start >= std::chrono::seconds(1)) {
+            window_start = now;
+            report_suppressed();
+        }
+    }
+}
+
+void LogSink::drain()
+{
+    bool wrote = false;
+
+    while (records->pop([this](int level, const char* text) { write_record(level, text); }))
+        wrote = true;
+
+    int dropped = records->take_dropped();
+    if (dropped > 0) {
+        char text[64];
+        snprintf(text, sizeof(text), "Log sink full, dropped %d messages", dropped);
+        write_record(LOG_WARNING, text);
+        wrote = true;
+    }
+
+    if (wrote) {
+        fflush(stdout);
+        if (file)
+            fflush(file);
+    }
+}
+
+void LogSink::write_record(int level, const char* text)
+{
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start_time;
+
+    printf("%s: %s\n", level_name(level), text);
+
+    if (!file)
+        return;
+
+    int written = fprintf(file, "[%10.3f] %s: %s\n", time.count(), level_name(level), text);
+    if (written > 0)
+        file_size += written;
+
+    if (max_file_size > 0 && file_size >= max_file_size)
+        rotate();
+}
+
+void LogSink::report_suppressed()
+{
+    for (int level = 0; level <= LOG_NONE; level++) {
+        sent[level].store(0, std::memory_order_relaxed);
+
+        int count = suppressed[level].exchange(0, std::memory_order_relaxed);
+        if (count > 0) {
+            char text[64];
+            snprintf(text, sizeof(text), "Rate limited %d %s messages", count, level_name(level));
+            write_record(LOG_WARNING, text);
+        }
+    }
+}
+
+//====================================================================
+// Files
+
+void LogSink::open_file()
+{
+    file = fopen(file_name.c_str(), "w");
+    file_size = 0;
+
+    if (!file)
+        printf("WARNING: Log sink could not open '%s'\n", file_name.c_str());
+}
+
+// log -> log.1 -> log.2 ... oldest one falls off the end
+void LogSink::rotate()
+{
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    for (int i = max_files - 1; i >= 1; i--) {
+        std::string from = i == 1 ? file_name : file_name + "." + std::to_string(i - 1);
+        std::string to = file_name + "." + std::to_string(i);
+        std::remove(to.c_str());
+        std::rename(from.c_str(), to.c_str());
+    }
+
+    open_file();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "message_ring.hpp"
+#include "raylib.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//====================================================================
+// Asynchronous TraceLog sink
+//
+// Replaces raylib's TraceLog output with a callback that formats records
+// into a lock-free ring. A background thread writes them to stdout and to a
+// rotating log file. Every log level has its own per second limit, anything
+// over it is counted and reported instead of written.
+
+class LogSink {
+public:
+    LogSink();
+    ~LogSink();
+
+    void start(const char* file_name, long max_file_size = 1024 * 1024, int max_files = 3);
+    void stop();
+
+    // Messages allowed per second for a log level, 0 for no limit
+    void set_rate_limit(int level, int per_second);
+
+private:
+    using RecordRing = MessageRing<1024, 256>;
+
+    static void trace_callback(int level, const char* text, va_list args);
+    void push(int level, const char* text, va_list args);
+
+    void writer_loop();
+    void drain();
+    void write_record(int level, const char* text);
+    void open_file();
+    void rotate();
+    void report_suppressed();
+
+private:
+    std::unique_ptr<RecordRing> records;
+
+    std::thread writer;
+    std::atomic<bool> running = false;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+
+    // Held while writing, the writer thread and fatal errors both drain
+    std::mutex file_mutex;
+    FILE* file = nullptr;
+    std::string file_name;
+    std::chrono::steady_clock::time_point start_time;
+    long file_size = 0;
+    long max_file_size = 0;
+    int max_files = 0;
+
+    std::atomic<int> sent[LOG_NONE + 1];
+    std::atomic<int> suppressed[LOG_NONE + 1];
+    int rate_limit[LOG_NONE + 1];
+};
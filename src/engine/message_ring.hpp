@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+
+//====================================================================
+// Fixed capacity, multi-producer multi-consumer lock-free message queue
+//
+// Every slot holds a pre-sized text buffer that messages are formatted
+// straight into, so pushing never allocates. Based on Dmitry Vyukov's
+// bounded MPMC queue: each slot carries a sequence number telling producers
+// and consumers whose turn it is.
+
+template <int Capacity, int SlotSize>
+class MessageRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "MessageRing capacity must be a power of 2");
+
+public:
+    MessageRing()
+    {
+        for (int i = 0; i < Capacity; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Returns false and drops the message if the ring is full
+    bool push(int tag, const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        bool pushed = push_v(tag, format, args);
+        va_end(args);
+        return pushed;
+    }
+
+    bool push_v(int tag, const char* format, va_list args)
+    {
+        Slot* slot = claim_write();
+        if (!slot) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slot->tag = tag;
+        vsnprintf(slot->text, SlotSize, format, args);
+
+        slot->sequence.store(slot->claimed + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Hand the oldest message to func(tag, text) and free its slot.
+    // Returns false if the ring is empty
+    template <class Func>
+    bool pop(Func&& func)
+    {
+        size_t pos = read_pos.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        while (true) {
+            slot = &slots[pos & (Capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)(pos + 1);
+
+            if (diff == 0) {
+                if (read_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0)
+                return false;
+            else
+                pos = read_pos.load(std::memory_order_relaxed);
+        }
+
+        func(slot->tag, (const char*)slot->text);
+
+        slot->sequence.store(pos + Capacity, std::memory_order_release);
+        return true;
+    }
+
+    // Number of messages dropped since the last call
+    inline int take_dropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    static constexpr int capacity = Capacity;
+    static constexpr int slot_size = SlotSize;
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        size_t claimed;
+        int tag;
+        char text[SlotSize];
+    };
+
+    Slot* claim_write()
+    {
+        size_t pos = write_pos.load(std::memory_order_relaxed);
+
+        while (true) {
+            Slot* slot = &slots[pos & (Capacity - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)pos;
+
+            if (diff == 0) {
+                if (write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot->claimed = pos;
+                    return slot;
+                }
+            } else if (diff < 0)
+                return nullptr;
+            else
+                pos = write_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    alignas(64) std::atomic<size_t> write_pos = 0;
+    alignas(64) std::atomic<size_t> read_pos = 0;
+    alignas(64) std::atomic<int> dropped = 0;
+
+    Slot slots[Capacity];
+};
@@ -4,6 +4,16 @@
 #include <cmath>
 #include <cstdlib>
 
+Rectangle get_bounds(CollisionEntity* entity)
+{
+    return Rectangle {
+        entity->pos.x - entity->half_width,
+        entity->pos.y - entity->half_height,
+        entity->half_width * 2.0f,
+        entity->half_height * 2.0f,
+    };
+}
+
 bool overlap_aabb(class CollisionEntity* entity_1, class CollisionEntity* entity_2)
 {
     const int e1_x1 = entity_1->pos.x - entity_1->half_width;
@@ -9,6 +9,14 @@ struct PhysicsData {
     float timestep = 1.0f / 60.0f;
     float accumulator = 0.0f;
     bool freeze_fixed_update = false;
+
+    // Step actors on the job system once there are enough of them
+    bool parallel_actors = true;
+    int parallel_min_actors = 256;
+    int parallel_batch_size = 64;
+
+    // Simulate the next tick on its own thread while the last one is drawn
+    bool pipelined = false;
 };
 
 struct Collision {
@@ -19,5 +27,6 @@ struct Collision {
     float time;
 };
 
+Rectangle get_bounds(class CollisionEntity* entity);
 bool overlap_aabb(class CollisionEntity* entity_1, class CollisionEntity* entity_2);
 std::optional<Collision> intersect_aabb(class CollisionEntity* solid, class CollisionEntity* actor);
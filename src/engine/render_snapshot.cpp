@@ -0,0 +1,28 @@
+#include "render_snapshot.hpp"
+
+// Keeps the capacity, a snapshot is refilled every tick
+void RenderSnapshot::clear()
+{
+    rects.clear();
+    valid = false;
+}
+
+void RenderSnapshot::add_rect(Rectangle rect, Color color)
+{
+    rects.push_back({ rect, { color, color, color, color }, false });
+}
+
+void RenderSnapshot::add_gradient(Rectangle rect, Color top_left, Color bottom_left, Color bottom_right, Color top_right)
+{
+    rects.push_back({ rect, { top_left, bottom_left, bottom_right, top_right }, true });
+}
+
+void RenderSnapshot::draw() const
+{
+    for (const RenderRect& rect : rects) {
+        if (rect.gradient)
+            DrawRectangleGradientEx(rect.rect, rect.colors[0], rect.colors[1], rect.colors[2], rect.colors[3]);
+        else
+            DrawRectangleRec(rect.rect, rect.colors[0]);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+//====================================================================
+// Everything needed to draw one tick of the world
+//
+// Entities capture what they would draw into it, so it can be drawn later
+// while the world itself has moved on.
+
+struct RenderRect {
+    Rectangle rect;
+    // Top left, bottom left, bottom right, top right
+    Color colors[4];
+    bool gradient;
+};
+
+class RenderSnapshot {
+public:
+    void clear();
+
+    void add_rect(Rectangle rect, Color color);
+    void add_gradient(Rectangle rect, Color top_left, Color bottom_left, Color bottom_right, Color top_right);
+
+    // Draws the rectangles only, camera and clear colour are left to the caller
+    void draw() const;
+
+public:
+    Camera2D camera = { 0 };
+    Color clear_color = RAYWHITE;
+    bool valid = false;
+
+private:
+    std::vector<RenderRect> rects;
+};
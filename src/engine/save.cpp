@@ -1,7 +1,20 @@
 #include "save.hpp"
 
+#include "../defs.hpp"
+#include "asset_pack.hpp"
 #include "entity.hpp"
+#include "jobs.hpp"
+#include "raylib.h"
 #include "world.hpp"
+#include <algorithm>
+#include <cereal/archives/json.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <typeinfo>
 
 void SaveData::ToRaw(Entity* entity)
 {
@@ -14,7 +27,7 @@ void SaveData::ToRaw(Entity* entity)
 
 SaveData::SaveData(World* world)
 {
-    version = "0.01";
+    version = "0.02";
 
     entities.clear();
 
@@ -29,3 +42,528 @@ RawEntity::RawEntity(int x, int y)
     , y(y)
 {
 }
+
+//====================================================================
+// Chunked level files
+//
+//   "CLVL", u32 format version, u32 chunk count, u32 version length, version
+//   chunk table, per chunk: u32 type, u32 entity count, u64 offset, u64 size
+//   chunk data, offsets start after the table
+//
+// Every chunk is decoded on its own, so big levels load on several threads.
+// Solids that are exactly one grid tile go into run length encoded tile
+// chunks, everything else is kept as a JSON entity record.
+// Levels saved before chunks were added are a single JSON document.
+
+static const char LEVEL_MAGIC[4] = { 'C', 'L', 'V', 'L' };
+static const unsigned int LEVEL_FORMAT_VERSION = 2;
+
+enum class ChunkType : unsigned int {
+    Entities = 0,
+    // Version 2
+    Tiles = 1,
+};
+
+// Tile chunks hold whole rows, a new chunk starts once this many tiles are in one
+static const size_t TILE_CHUNK_TILES = 1 << 16;
+
+struct ChunkHeader {
+    unsigned int type;
+    unsigned int entity_count;
+    unsigned long long offset;
+    unsigned long long size;
+};
+
+struct EntityChunk {
+    std::vector<std::unique_ptr<RawEntity>> entities;
+
+    template <class Archive>
+    void serialize(Archive& archive)
+    {
+        archive(cereal::make_nvp("entities", entities));
+    }
+};
+
+static const int CHUNK_HEADER_SIZE = 24;
+
+static void put_u32(std::string* bytes, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+        bytes->push_back((char)((value >> (i * 8)) & 0xFF));
+}
+
+static void put_u64(std::string* bytes, unsigned long long value)
+{
+    for (int i = 0; i < 8; i++)
+        bytes->push_back((char)((value >> (i * 8)) & 0xFF));
+}
+
+static bool get_u32(std::string_view bytes, size_t* pos, unsigned int* value)
+{
+    if (*pos + 4 > bytes.size())
+        return false;
+
+    *value = 0;
+    for (int i = 0; i < 4; i++)
+        *value |= (unsigned int)(unsigned char)bytes[*pos + i] << (i * 8);
+
+    *pos += 4;
+    return true;
+}
+
+static bool get_u64(std::string_view bytes, size_t* pos, unsigned long long* value)
+{
+    if (*pos + 8 > bytes.size())
+        return false;
+
+    *value = 0;
+    for (int i = 0; i < 8; i++)
+        *value |= (unsigned long long)(unsigned char)bytes[*pos + i] << (i * 8);
+
+    *pos += 8;
+    return true;
+}
+
+// LEB128, small numbers take a single byte
+static void put_varint(std::string* bytes, unsigned long long value)
+{
+    while (value >= 0x80) {
+        bytes->push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    bytes->push_back((char)value);
+}
+
+static bool get_varint(std::string_view bytes, size_t* pos, size_t end, unsigned long long* value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= end)
+            return false;
+
+        unsigned char byte = bytes[*pos];
+        *pos += 1;
+
+        *value |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+// Deltas can be negative, zigzag keeps small ones small
+static unsigned long long zigzag(long long value)
+{
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+static long long unzigzag(unsigned long long value)
+{
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+//----------------------------------------------
+// Tile chunks
+//
+//   cell width, cell height, tile half width, tile half height, row count
+//   per row: row delta, run count
+//   per run: gap from the end of the previous run in the row, run length
+//
+// Everything is a varint, deltas are zigzagged. Rows are sorted, as are
+// runs within a row.
+
+struct TileCell {
+    int x;
+    int y;
+    size_t index;
+};
+
+static bool get_tile_cell(RawEntity* raw, TileCell* cell)
+{
+    if (typeid(*raw) != typeid(RawSolid))
+        return false;
+
+    RawSolid* solid = static_cast<RawSolid*>(raw);
+    if (solid->half_width != TILE_WIDTH / 2 || solid->half_height != TILE_HEIGHT / 2)
+        return false;
+
+    int left = solid->x - solid->half_width;
+    int top = solid->y - solid->half_height;
+    if (left % TILE_WIDTH != 0 || top % TILE_HEIGHT != 0)
+        return false;
+
+    cell->x = left / TILE_WIDTH;
+    cell->y = top / TILE_HEIGHT;
+    return true;
+}
+
+// tiles[begin, end) is sorted and holds whole rows
+static void encode_tile_chunk(const std::vector<TileCell>& tiles, size_t begin, size_t end, std::string* bytes)
+{
+    put_varint(bytes, TILE_WIDTH);
+    put_varint(bytes, TILE_HEIGHT);
+    put_varint(bytes, TILE_WIDTH / 2);
+    put_varint(bytes, TILE_HEIGHT / 2);
+
+    int rows = 0;
+    for (size_t i = begin; i < end; i++)
+        rows += i == begin || tiles[i].y != tiles[i - 1].y;
+    put_varint(bytes, rows);
+
+    long long previous_row = 0;
+    size_t row_start = begin;
+
+    while (row_start < end) {
+        int row = tiles[row_start].y;
+        size_t row_end = row_start;
+        while (row_end < end && tiles[row_end].y == row)
+            row_end++;
+
+        int runs = 0;
+        for (size_t i = row_start; i < row_end; i++)
+            runs += i == row_start || tiles[i].x != tiles[i - 1].x + 1;
+
+        put_varint(bytes, zigzag(row - previous_row));
+        put_varint(bytes, runs);
+        previous_row = row;
+
+        long long previous_end = 0;
+        size_t run_start = row_start;
+
+        while (run_start < row_end) {
+            size_t run_end = run_start + 1;
+            while (run_end < row_end && tiles[run_end].x == tiles[run_end - 1].x + 1)
+                run_end++;
+
+            put_varint(bytes, zigzag(tiles[run_start].x - previous_end));
+            put_varint(bytes, run_end - run_start);
+            previous_end = tiles[run_start].x + (long long)(run_end - run_start);
+
+            run_start = run_end;
+        }
+
+        row_start = row_end;
+    }
+}
+
+static bool decode_tile_chunk(std::string_view bytes, size_t begin, size_t size, unsigned int tile_count, EntityChunk* chunk)
+{
+    size_t pos = begin;
+    size_t end = begin + size;
+
+    unsigned long long cell_width, cell_height, half_width, half_height, rows;
+    if (!get_varint(bytes, &pos, end, &cell_width) || !get_varint(bytes, &pos, end, &cell_height)
+        || !get_varint(bytes, &pos, end, &half_width) || !get_varint(bytes, &pos, end, &half_height)
+        || !get_varint(bytes, &pos, end, &rows))
+        return false;
+
+    chunk->entities.reserve(tile_count);
+    long long row = 0;
+
+    for (unsigned long long r = 0; r < rows; r++) {
+        unsigned long long row_delta, runs;
+        if (!get_varint(bytes, &pos, end, &row_delta) || !get_varint(bytes, &pos, end, &runs))
+            return false;
+
+        row += unzigzag(row_delta);
+        long long x = 0;
+
+        for (unsigned long long run = 0; run < runs; run++) {
+            unsigned long long gap, length;
+            if (!get_varint(bytes, &pos, end, &gap) || !get_varint(bytes, &pos, end, &length))
+                return false;
+
+            // A broken length shouldn't be able to eat all the memory
+            if (chunk->entities.size() + length > tile_count)
+                return false;
+
+            x += unzigzag(gap);
+
+            for (unsigned long long i = 0; i < length; i++, x++) {
+                chunk->entities.push_back(std::make_unique<RawSolid>(
+                    (int)(x * (long long)cell_width + (long long)half_width),
+                    (int)(row * (long long)cell_height + (long long)half_height),
+                    (int)half_width,
+                    (int)half_height));
+            }
+        }
+    }
+
+    return chunk->entities.size() == tile_count;
+}
+
+//----------------------------------------------
+
+static bool read_legacy_save(const std::string& file_name, std::string_view bytes, SaveData* data)
+{
+    std::istringstream stream { std::string(bytes) };
+
+    try {
+        cereal::JSONInputArchive archive(stream);
+        archive(*data);
+    } catch (cereal::Exception val) {
+        TraceLog(LOG_WARNING, "Could not deserialise level '%s' - %s", file_name.c_str(), val.what());
+        return false;
+    }
+
+    return true;
+}
+
+static bool read_chunked_save(const std::string& file_name, std::string_view bytes, SaveData* data, JobSystem* jobs)
+{
+    size_t pos = sizeof(LEVEL_MAGIC);
+    unsigned int format_version;
+    unsigned int chunk_count;
+    unsigned int version_length;
+
+    if (!get_u32(bytes, &pos, &format_version) || !get_u32(bytes, &pos, &chunk_count) || !get_u32(bytes, &pos, &version_length)
+        || pos + version_length > bytes.size()) {
+        TraceLog(LOG_WARNING, "Level '%s' has a broken header", file_name.c_str());
+        return false;
+    }
+
+    if (format_version > LEVEL_FORMAT_VERSION) {
+        TraceLog(LOG_WARNING, "Level '%s' is from a newer version (%u)", file_name.c_str(), format_version);
+        return false;
+    }
+
+    data->version = std::string(bytes.substr(pos, version_length));
+    pos += version_length;
+
+    if (pos + (size_t)chunk_count * CHUNK_HEADER_SIZE > bytes.size()) {
+        TraceLog(LOG_WARNING, "Level '%s' has a broken chunk table", file_name.c_str());
+        return false;
+    }
+
+    std::vector<ChunkHeader> headers(chunk_count);
+    for (ChunkHeader& header : headers) {
+        get_u32(bytes, &pos, &header.type);
+        get_u32(bytes, &pos, &header.entity_count);
+        get_u64(bytes, &pos, &header.offset);
+        get_u64(bytes, &pos, &header.size);
+    }
+
+    const size_t data_start = pos;
+
+    for (ChunkHeader& header : headers) {
+        if (header.offset > bytes.size() - data_start || header.size > bytes.size() - data_start - header.offset) {
+            TraceLog(LOG_WARNING, "Level '%s' has a chunk outside the file", file_name.c_str());
+            return false;
+        }
+    }
+
+    std::vector<EntityChunk> chunks(chunk_count);
+    std::vector<std::string> errors(chunk_count);
+
+    auto decode = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            ChunkHeader& header = headers[i];
+
+            if (header.type == (unsigned int)ChunkType::Tiles) {
+                if (!decode_tile_chunk(bytes, data_start + header.offset, header.size, header.entity_count, &chunks[i]))
+                    errors[i] = "Broken tile chunk";
+                continue;
+            }
+
+            // Unknown chunks are from newer versions, skip them
+            if (header.type != (unsigned int)ChunkType::Entities)
+                continue;
+
+            std::istringstream stream { std::string(bytes.substr(data_start + header.offset, header.size)) };
+
+            try {
+                cereal::JSONInputArchive archive(stream);
+                archive(chunks[i]);
+            } catch (cereal::Exception val) {
+                errors[i] = val.what();
+            }
+        }
+    };
+
+    if (jobs)
+        jobs->parallel_for(chunk_count, 1, decode);
+    else
+        decode(0, chunk_count);
+
+    // Merged in file order, whichever thread decoded what
+    size_t entity_count = 0;
+
+    for (unsigned int i = 0; i < chunk_count; i++) {
+        if (!errors[i].empty()) {
+            TraceLog(LOG_WARNING, "Could not deserialise chunk %u of level '%s' - %s", i, file_name.c_str(), errors[i].c_str());
+            return false;
+        }
+
+        entity_count += chunks[i].entities.size();
+    }
+
+    data->entities.reserve(data->entities.size() + entity_count);
+
+    for (EntityChunk& chunk : chunks) {
+        for (std::unique_ptr<RawEntity>& entity : chunk.entities)
+            data->entities.push_back(std::move(entity));
+    }
+
+    return true;
+}
+
+bool read_save_file(const std::string& file_name, SaveData* data, JobSystem* jobs)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    if (!file.is_open()) {
+        TraceLog(LOG_WARNING, "Could not open level '%s'", file_name.c_str());
+        return false;
+    }
+
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return read_save_data(file_name, bytes, data, jobs);
+}
+
+bool read_save_data(const std::string& name, std::string_view bytes, SaveData* data, JobSystem* jobs)
+{
+    if (bytes.size() >= sizeof(LEVEL_MAGIC) && memcmp(bytes.data(), LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) == 0)
+        return read_chunked_save(name, bytes, data, jobs);
+
+    return read_legacy_save(name, bytes, data);
+}
+
+bool read_level(const std::string& file_name, SaveData* data, const AssetPack* pack, JobSystem* jobs)
+{
+    AssetView view;
+    std::vector<unsigned char> storage;
+
+    if (pack && !FileExists(file_name.c_str()) && pack->get(file_name, &view, &storage))
+        return read_save_data(file_name, std::string_view((const char*)view.data, view.size), data, jobs);
+
+    return read_save_file(file_name, data, jobs);
+}
+
+//----------------------------------------------
+
+static bool encode_chunks(const std::string& file_name, SaveData* data, std::string* bytes)
+{
+    std::vector<ChunkHeader> headers;
+    std::string chunk_data;
+
+    // Split grid tiles from everything else
+    std::vector<TileCell> tiles;
+    std::vector<size_t> records;
+
+    for (size_t i = 0; i < data->entities.size(); i++) {
+        TileCell cell;
+        if (get_tile_cell(data->entities[i].get(), &cell)) {
+            cell.index = i;
+            tiles.push_back(cell);
+        } else
+            records.push_back(i);
+    }
+
+    std::sort(tiles.begin(), tiles.end(), [](const TileCell& a, const TileCell& b) {
+        return a.y != b.y ? a.y < b.y : (a.x != b.x ? a.x < b.x : a.index < b.index);
+    });
+
+    // Stacked duplicates can't be run length encoded, they stay records
+    size_t unique_count = 0;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        if (i > 0 && tiles[i].x == tiles[i - 1].x && tiles[i].y == tiles[i - 1].y)
+            records.push_back(tiles[i].index);
+        else
+            tiles[unique_count++] = tiles[i];
+    }
+    tiles.resize(unique_count);
+    std::sort(records.begin(), records.end());
+
+    for (size_t begin = 0; begin < tiles.size();) {
+        size_t end = std::min(begin + TILE_CHUNK_TILES, tiles.size());
+        while (end < tiles.size() && tiles[end].y == tiles[end - 1].y)
+            end++;
+
+        size_t offset = chunk_data.size();
+        encode_tile_chunk(tiles, begin, end, &chunk_data);
+        headers.push_back({ (unsigned int)ChunkType::Tiles, (unsigned int)(end - begin), offset, chunk_data.size() - offset });
+
+        begin = end;
+    }
+
+    for (size_t begin = 0; begin < records.size(); begin += SAVE_CHUNK_ENTITIES) {
+        size_t end = std::min(begin + SAVE_CHUNK_ENTITIES, records.size());
+
+        // Borrow the entities for the chunk, they go straight back afterwards
+        EntityChunk chunk;
+        for (size_t i = begin; i < end; i++)
+            chunk.entities.push_back(std::move(data->entities[records[i]]));
+
+        std::ostringstream stream;
+        bool success = true;
+
+        try {
+            cereal::JSONOutputArchive archive(stream, cereal::JSONOutputArchive::Options::NoIndent());
+            archive(chunk);
+        } catch (cereal::Exception val) {
+            TraceLog(LOG_WARNING, "Could not serialise '%s' - %s", file_name.c_str(), val.what());
+            success = false;
+        }
+
+        for (size_t i = begin; i < end; i++)
+            data->entities[records[i]] = std::move(chunk.entities[i - begin]);
+
+        if (!success)
+            return false;
+
+        std::string text = stream.str();
+        headers.push_back({ (unsigned int)ChunkType::Entities, (unsigned int)(end - begin), chunk_data.size(), text.size() });
+        chunk_data.append(text);
+    }
+
+    bytes->append(LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    put_u32(bytes, LEVEL_FORMAT_VERSION);
+    put_u32(bytes, headers.size());
+    put_u32(bytes, data->version.size());
+    bytes->append(data->version);
+
+    for (ChunkHeader& header : headers) {
+        put_u32(bytes, header.type);
+        put_u32(bytes, header.entity_count);
+        put_u64(bytes, header.offset);
+        put_u64(bytes, header.size);
+    }
+
+    bytes->append(chunk_data);
+    return true;
+}
+
+bool write_save_file(const std::string& file_name, SaveData* data)
+{
+    std::string bytes;
+    if (!encode_chunks(file_name, data, &bytes))
+        return false;
+
+    std::string temp_name = file_name + ".tmp";
+
+    {
+        std::ofstream file(temp_name, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        file.write(bytes.data(), bytes.size());
+        file.close();
+
+        if (file.fail()) {
+            std::remove(temp_name.c_str());
+            return false;
+        }
+    }
+
+    // Replaces atomically on POSIX, Windows needs the old file out of the way first
+    if (std::rename(temp_name.c_str(), file_name.c_str()) != 0) {
+        std::remove(file_name.c_str());
+        if (std::rename(temp_name.c_str(), file_name.c_str()) != 0) {
+            std::remove(temp_name.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
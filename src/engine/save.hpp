@@ -7,6 +7,7 @@
 #include <cereal/types/polymorphic.hpp>
 #include <cereal/types/vector.hpp>
 #include <string>
+#include <string_view>
 #include <vector>
 
 //====================================================================
@@ -33,6 +34,20 @@ private:
     void ToRaw(class Entity* entity);
 };
 
+// Entities per chunk in a level file, chunks are decoded in parallel when loading
+static const size_t SAVE_CHUNK_ENTITIES = 4096;
+
+// False if the file couldn't be opened or parsed, the reason is logged.
+// Chunks are spread over the job system if one is given
+bool read_save_file(const std::string& file_name, SaveData* data, class JobSystem* jobs = nullptr);
+// Same as read_save_file for a level already in memory, name is only used for logging
+bool read_save_data(const std::string& name, std::string_view bytes, SaveData* data, class JobSystem* jobs = nullptr);
+// Levels on disk win over the ones shipped in the asset pack, so edited levels load
+bool read_level(const std::string& file_name, SaveData* data, const class AssetPack* pack, class JobSystem* jobs = nullptr);
+
+// Writes to a temporary file first and renames it over file_name, so a reader never sees half a level
+bool write_save_file(const std::string& file_name, SaveData* data);
+
 //====================================================================
 
 class IToRawData {
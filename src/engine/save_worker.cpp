@@ -0,0 +1,125 @@
+#include "save_worker.hpp"
+
+#include "save.hpp"
+#include <chrono>
+
+//====================================================================
+
+SaveWorker::~SaveWorker()
+{
+    stop();
+}
+
+void SaveWorker::start()
+{
+    if (running)
+        return;
+
+    running = true;
+    worker = std::thread(&SaveWorker::worker_loop, this);
+}
+
+void SaveWorker::stop()
+{
+    if (!running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void SaveWorker::queue(const std::string& file_name, std::unique_ptr<SaveData> data, bool is_autosave, Callback on_written)
+{
+    Job job { file_name, std::move(data), is_autosave, std::move(on_written) };
+
+    // Nowhere to hand it off to, write it here
+    if (!running) {
+        SaveResult result = write(job);
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(result);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void SaveWorker::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return jobs.empty() && !busy; });
+}
+
+bool SaveWorker::is_idle()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.empty() && !busy;
+}
+
+void SaveWorker::take_results(std::vector<SaveResult>* out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    out->insert(out->end(), results.begin(), results.end());
+    results.clear();
+}
+
+//====================================================================
+
+void SaveWorker::worker_loop()
+{
+    while (true) {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !running || !jobs.empty(); });
+
+            // Only leave once the queue is empty
+            if (jobs.empty())
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+        }
+
+        SaveResult result = write(job);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result);
+            busy = false;
+        }
+        idle.notify_all();
+    }
+}
+
+SaveResult SaveWorker::write(Job& job)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    bool success = write_save_file(job.file_name, job.data.get());
+    if (job.on_written)
+        job.on_written(success);
+
+    LevelInfo info;
+    std::filesystem::file_time_type written_time;
+    if (success) {
+        std::error_code error;
+        written_time = std::filesystem::last_write_time(job.file_name, error);
+        LevelCatalog::summarize(*job.data, &info);
+    }
+
+    // Free the snapshot here rather than on the main thread
+    job.data.reset();
+
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    return SaveResult { job.file_name, success, job.is_autosave, time.count(), std::move(info), written_time };
+}
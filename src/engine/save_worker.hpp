@@ -0,0 +1,76 @@
+#pragma once
+
+#include "level_catalog.hpp"
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//====================================================================
+// Background level writer
+//
+// The world snapshot is taken on the main thread and handed over here.
+// Saves are written one at a time in the order they were queued, through a
+// temporary file that is renamed over the level. Results are collected for
+// the main thread to report.
+
+struct SaveResult {
+    std::string file_name;
+    bool success;
+    bool is_autosave;
+    double seconds;
+
+    // Summary of what was written, so the catalog doesn't have to read it back
+    LevelInfo info;
+    // Modification time straight after the write, tells our own writes apart from outside edits
+    std::filesystem::file_time_type written_time;
+};
+
+class SaveWorker {
+public:
+    // Runs on the worker thread once the file is written (or failed to)
+    using Callback = std::function<void(bool success)>;
+
+    SaveWorker() { }
+    ~SaveWorker();
+
+    void start();
+    // Finishes everything already queued first
+    void stop();
+
+    void queue(const std::string& file_name, std::unique_ptr<struct SaveData> data, bool is_autosave, Callback on_written = nullptr);
+
+    // Blocks until every queued save is on disk
+    void wait();
+    bool is_idle();
+
+    void take_results(std::vector<SaveResult>* out);
+
+private:
+    struct Job {
+        std::string file_name;
+        std::unique_ptr<struct SaveData> data;
+        bool is_autosave;
+        Callback on_written;
+    };
+
+    void worker_loop();
+    SaveResult write(Job& job);
+
+private:
+    std::thread worker;
+    bool running = false;
+    bool busy = false;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Job> jobs;
+
+    std::vector<SaveResult> results;
+};
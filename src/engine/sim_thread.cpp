@@ -0,0 +1,80 @@
+#include "sim_thread.hpp"
+
+SimThread::~SimThread()
+{
+    stop();
+}
+
+void SimThread::start()
+{
+    if (running)
+        return;
+
+    running = true;
+    thread = std::thread(&SimThread::thread_loop, this);
+}
+
+void SimThread::stop()
+{
+    if (!running)
+        return;
+
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void SimThread::run(std::function<void()> new_job)
+{
+    if (!running) {
+        new_job();
+        return;
+    }
+
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = std::move(new_job);
+        busy = true;
+    }
+    wake.notify_all();
+}
+
+void SimThread::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return !busy; });
+}
+
+//====================================================================
+
+void SimThread::thread_loop()
+{
+    while (true) {
+        std::function<void()> current;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !running || busy; });
+
+            if (!busy)
+                return;
+
+            current = std::move(job);
+        }
+
+        current();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy = false;
+        }
+        done.notify_all();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//====================================================================
+// Thread for running the simulation next to rendering
+//
+// Holds at most one job at a time. The main thread hands a tick over with
+// run, draws the last snapshot, then waits for the tick before touching the
+// world again.
+
+class SimThread {
+public:
+    SimThread() { }
+    ~SimThread();
+
+    void start();
+    // Finishes the running job first
+    void stop();
+
+    // Waits for the previous job if there still is one. Runs inline when not started
+    void run(std::function<void()> job);
+    void wait();
+
+    inline bool is_running() { return running; }
+
+private:
+    void thread_loop();
+
+private:
+    std::thread thread;
+    bool running = false;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    std::function<void()> job;
+    bool busy = false;
+};
@@ -0,0 +1,157 @@
+#include "spatial.hpp"
+
+#include "entity.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Entities touching more cells than this go in the oversized list instead
+static const int MAX_ENTITY_CELLS = 1024;
+
+//====================================================================
+
+SpatialGrid::SpatialGrid(int cell_size)
+    : cell_size(cell_size)
+{
+}
+
+long long SpatialGrid::cell_key(int x, int y)
+{
+    return ((long long)x << 32) ^ (unsigned int)y;
+}
+
+SpatialGrid::CellRange SpatialGrid::get_range(Rectangle area) const
+{
+    return {
+        (int)std::floor(area.x / cell_size),
+        (int)std::floor(area.y / cell_size),
+        (int)std::floor((area.x + area.width) / cell_size),
+        (int)std::floor((area.y + area.height) / cell_size),
+    };
+}
+
+// Padded by a pixel, overlap tests truncate positions to ints
+SpatialGrid::CellRange SpatialGrid::get_range(CollisionEntity* entity) const
+{
+    return get_range({
+        entity->pos.x - entity->half_width - 1.0f,
+        entity->pos.y - entity->half_height - 1.0f,
+        entity->half_width * 2.0f + 2.0f,
+        entity->half_height * 2.0f + 2.0f,
+    });
+}
+
+//====================================================================
+
+void SpatialGrid::insert(CollisionEntity* entity)
+{
+    if (contains(entity))
+        return;
+
+    CellRange range = get_range(entity);
+    Entry entry = { entity, range, next_order++ };
+
+    long long cell_count = (long long)(range.x2 - range.x1 + 1) * (range.y2 - range.y1 + 1);
+    bool is_oversized = cell_count > MAX_ENTITY_CELLS;
+
+    ranges[entity] = { range, is_oversized };
+
+    if (is_oversized) {
+        oversized.push_back(entry);
+        return;
+    }
+
+    for (int y = range.y1; y <= range.y2; y++)
+        for (int x = range.x1; x <= range.x2; x++)
+            cells[cell_key(x, y)].push_back(entry);
+}
+
+void SpatialGrid::remove(CollisionEntity* entity)
+{
+    auto it = ranges.find(entity);
+    if (it == ranges.end())
+        return;
+
+    Placement placement = it->second;
+    ranges.erase(it);
+
+    auto remove_from = [entity](std::vector<Entry>* entries) {
+        for (int i = 0; i < entries->size(); i++) {
+            if ((*entries)[i].entity == entity) {
+                (*entries)[i] = entries->back();
+                entries->pop_back();
+                return;
+            }
+        }
+    };
+
+    if (placement.oversized) {
+        remove_from(&oversized);
+        return;
+    }
+
+    CellRange range = placement.range;
+    for (int y = range.y1; y <= range.y2; y++) {
+        for (int x = range.x1; x <= range.x2; x++) {
+            auto cell = cells.find(cell_key(x, y));
+            if (cell == cells.end())
+                continue;
+
+            remove_from(&cell->second);
+            if (cell->second.empty())
+                cells.erase(cell);
+        }
+    }
+}
+
+// Call after an entity has moved or changed size
+void SpatialGrid::update(CollisionEntity* entity)
+{
+    remove(entity);
+    insert(entity);
+}
+
+void SpatialGrid::clear()
+{
+    cells.clear();
+    ranges.clear();
+    oversized.clear();
+    next_order = 0;
+}
+
+//====================================================================
+
+void SpatialGrid::query(Rectangle area, std::vector<CollisionEntity*>* results) const
+{
+    static thread_local std::vector<Entry> found;
+    found.clear();
+
+    CellRange query_range = get_range(area);
+
+    for (int y = query_range.y1; y <= query_range.y2; y++) {
+        for (int x = query_range.x1; x <= query_range.x2; x++) {
+            auto cell = cells.find(cell_key(x, y));
+            if (cell == cells.end())
+                continue;
+
+            for (const Entry& entry : cell->second) {
+                // Entities spanning several cells are only reported from the first cell shared with the query
+                if (x != std::max(entry.range.x1, query_range.x1) || y != std::max(entry.range.y1, query_range.y1))
+                    continue;
+
+                found.push_back(entry);
+            }
+        }
+    }
+
+    for (const Entry& entry : oversized) {
+        if (entry.range.x1 <= query_range.x2 && entry.range.x2 >= query_range.x1
+            && entry.range.y1 <= query_range.y2 && entry.range.y2 >= query_range.y1)
+            found.push_back(entry);
+    }
+
+    // Keep results independent of hash map layout
+    std::sort(found.begin(), found.end(), [](const Entry& a, const Entry& b) { return a.order < b.order; });
+
+    for (const Entry& entry : found)
+        results->push_back(entry.entity);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "raylib.h"
+#include <unordered_map>
+#include <vector>
+
+//====================================================================
+// Uniform grid broadphase
+//
+// Entities are stored in every cell their bounds touch. Queries return
+// candidates in insertion order, callers still need to do the exact test.
+
+class SpatialGrid {
+public:
+    SpatialGrid(int cell_size = 128);
+
+    void insert(class CollisionEntity* entity);
+    void remove(class CollisionEntity* entity);
+    void update(class CollisionEntity* entity);
+    void clear();
+
+    template <class T>
+    void rebuild(const std::vector<T*>& entities)
+    {
+        clear();
+        for (T* entity : entities)
+            insert(entity);
+    }
+
+    inline bool contains(class CollisionEntity* entity) { return ranges.count(entity) > 0; }
+    inline int size() { return ranges.size(); }
+
+    // Entities whose cells touch the area. Safe to call from several threads while nothing is modifying the grid
+    void query(Rectangle area, std::vector<class CollisionEntity*>* results) const;
+
+private:
+    struct CellRange {
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    struct Entry {
+        class CollisionEntity* entity;
+        CellRange range;
+        unsigned int order;
+    };
+
+    struct Placement {
+        CellRange range;
+        bool oversized;
+    };
+
+    CellRange get_range(Rectangle area) const;
+    CellRange get_range(class CollisionEntity* entity) const;
+    static long long cell_key(int x, int y);
+
+private:
+    int cell_size;
+    unsigned int next_order = 0;
+
+    std::unordered_map<long long, std::vector<Entry>> cells;
+    std::unordered_map<class CollisionEntity*, Placement> ranges;
+
+    // Entities covering too many cells to be worth splitting up, checked by every query
+    std::vector<Entry> oversized;
+};
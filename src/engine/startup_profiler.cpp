@@ -0,0 +1,73 @@
+#include "startup_profiler.hpp"
+
+#include "raylib.h"
+#include <cstdio>
+#include <ctime>
+
+void StartupProfiler::begin()
+{
+    start_time = std::chrono::steady_clock::now();
+    phase_start = 0.0;
+    phases.clear();
+
+    first_frame_seconds = -1.0;
+    level_seconds = -1.0;
+    reported = false;
+}
+
+void StartupProfiler::mark(const char* phase)
+{
+    double now = since_begin();
+    phases.push_back({ phase, now - phase_start });
+    phase_start = now;
+}
+
+void StartupProfiler::first_frame()
+{
+    if (first_frame_seconds >= 0.0)
+        return;
+
+    first_frame_seconds = since_begin();
+    mark("first_frame");
+}
+
+void StartupProfiler::level_ready()
+{
+    if (level_seconds < 0.0)
+        level_seconds = since_begin();
+}
+
+double StartupProfiler::since_begin()
+{
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start_time;
+    return time.count();
+}
+
+//====================================================================
+
+void StartupProfiler::report(const char* history_file)
+{
+    if (reported || !is_done())
+        return;
+
+    reported = true;
+
+    TraceLog(LOG_INFO, "--------Startup times--------");
+    for (Phase& phase : phases)
+        TraceLog(LOG_INFO, "    %-16s %8.2fms", phase.name.c_str(), phase.seconds * 1000.0);
+    TraceLog(LOG_INFO, "    First frame after %.2fms, level ready after %.2fms",
+        first_frame_seconds * 1000.0, level_seconds * 1000.0);
+
+    // time  first frame ms  level ms  phase=ms ...
+    FILE* file = fopen(history_file, "a");
+    if (!file) {
+        TraceLog(LOG_WARNING, "Could not append startup times to '%s'", history_file);
+        return;
+    }
+
+    fprintf(file, "%lld\t%.2f\t%.2f", (long long)time(nullptr), first_frame_seconds * 1000.0, level_seconds * 1000.0);
+    for (Phase& phase : phases)
+        fprintf(file, "\t%s=%.2f", phase.name.c_str(), phase.seconds * 1000.0);
+    fprintf(file, "\n");
+    fclose(file);
+}
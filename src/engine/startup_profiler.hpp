@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+//====================================================================
+// Startup phase timing
+//
+// Each mark ends the phase before it, presenting the first frame is a phase
+// of its own. Time to first frame is taken once the first frame has been
+// presented, time to level once the default level is in the world. Both end
+// up in the log and in a history file, one line per run.
+
+class StartupProfiler {
+public:
+    void begin();
+    void mark(const char* phase);
+    void first_frame();
+    void level_ready();
+
+    inline bool is_first_frame_done() { return first_frame_seconds >= 0.0; }
+    inline bool is_done() { return first_frame_seconds >= 0.0 && level_seconds >= 0.0; }
+    inline double get_first_frame_seconds() { return first_frame_seconds; }
+    inline double get_level_seconds() { return level_seconds; }
+
+    // Logs every phase and appends the totals to history_file, once both are known
+    void report(const char* history_file);
+
+private:
+    double since_begin();
+
+private:
+    struct Phase {
+        std::string name;
+        double seconds;
+    };
+
+    std::chrono::steady_clock::time_point start_time;
+    double phase_start = 0.0;
+    std::vector<Phase> phases;
+
+    double first_frame_seconds = -1.0;
+    double level_seconds = -1.0;
+    bool reported = false;
+};
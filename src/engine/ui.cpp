@@ -1,34 +1,74 @@
 #include "ui.hpp"
 
+#include "asset_pack.hpp"
 #include "debug.hpp"
+#include "level_thumbnails.hpp"
 #include "raygui.h"
 #include "raylib.h"
 #include "raymath.h"
+#include <algorithm>
+#include <cmath>
 #include <variant>
 
-int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty> properties, int* scroll_index)
-{
-    int total_lines = 0;
+#define RAYGUI_IMPLEMENTATION
+#include "raygui.h"
 
-    struct VisitPropertyHeight {
-        int operator()(int*) { return 1; }
-        int operator()(bool*) { return 1; }
-        int operator()(float*) { return 1; }
-        int operator()(Vector2*) { return 2; }
-    };
+struct VisitPropertyHeight {
+    int operator()(int*) { return 1; }
+    int operator()(bool*) { return 1; }
+    int operator()(float*) { return 1; }
+    int operator()(Vector2*) { return 2; }
+};
 
-    for (DebugProperty property : properties) {
-        int height = std::visit(VisitPropertyHeight(), property.property_type);
-        total_lines += height;
-    }
+static int get_property_height(DebugProperty* property)
+{
+    return std::visit(VisitPropertyHeight(), property->property_type);
+}
 
+// Draws a list of editable properties. Only the rows that fit inside bounds are laid out and drawn,
+// scroll_index is the first property shown. Scroll with the mouse wheel over the names or drag the scroll bar.
+// total_lines caches the height of the whole list for the scroll bar, set it below 0 when the list changes.
+// Returns the index of the property whose name was clicked, or -1
+int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty>& properties, int* scroll_index, int* total_lines)
+{
     const int list_items_spacing = GuiGetStyle(LISTVIEW, LIST_ITEMS_SPACING);
     const int list_items_height = GuiGetStyle(LISTVIEW, LIST_ITEMS_HEIGHT);
     const int default_border_width = GuiGetStyle(DEFAULT, BORDER_WIDTH);
     const int list_scrollbar_width = GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH);
     const int default_text_padding = GuiGetStyle(DEFAULT, TEXT_PADDING);
 
-    // bool use_scroll_bar = (list_items_height + list_items_spacing * total_lines) > bounds.height;
+    const int line_height = list_items_height + list_items_spacing;
+    const int visible_lines = std::max(1, (int)(bounds.height - list_items_spacing - 2 * default_border_width) / line_height);
+
+    // Find the furthest we can scroll while still filling the view
+    int tail_lines = 0;
+    int max_start_index = std::max(0, (int)properties.size() - 1);
+
+    for (int i = properties.size() - 1; i >= 0; i--) {
+        tail_lines += get_property_height(&properties[i]);
+        if (tail_lines > visible_lines)
+            break;
+        max_start_index = i;
+    }
+
+    const bool use_scroll_bar = max_start_index > 0;
+
+    // Only the scroll bar needs the whole height, so it is summed once per list
+    int list_lines = tail_lines;
+    if (use_scroll_bar) {
+        if (total_lines != nullptr && *total_lines >= 0)
+            list_lines = *total_lines;
+        else {
+            list_lines = 0;
+            for (DebugProperty& property : properties)
+                list_lines += get_property_height(&property);
+        }
+    }
+
+    if (total_lines != nullptr && use_scroll_bar)
+        *total_lines = list_lines;
+
+    int start_index = (scroll_index == nullptr) ? 0 : *scroll_index;
 
     // Calculate size of property box
     Rectangle item_bounds = { 0 };
@@ -37,21 +77,8 @@ int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty> properties,
     item_bounds.width = bounds.width - 2 * list_items_spacing - default_border_width;
     item_bounds.height = list_items_height;
 
-    // TODO - Property scrolling
-    // if (use_scroll_bar)
-    //     item_bounds.width -= list_scrollbar_width;
-
-    // Get items on list
-    // int visible_items = (int)bounds.height / (list_items_height + list_items_spacing);
-    // if (visible_items > total_lines)
-    //     visible_items = total_lines;
-
-    // int start_index = (scroll_index == nullptr) ? 0 : *scroll_index;
-    // if (start_index < 0 || start_index > (total_lines - visible_items))
-    //     start_index = 0;
-    // int end_index = start_index + visible_items;
-
-    GuiGroupBox(bounds, NULL);
+    if (use_scroll_bar)
+        item_bounds.width -= list_scrollbar_width;
 
     Rectangle item_inner_bounds = { 0 };
     item_inner_bounds.x = item_bounds.x + default_border_width;
@@ -62,10 +89,55 @@ int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty> properties,
     const float default_value_width = item_inner_bounds.width - default_label_width;
     const float default_value_x = item_inner_bounds.x + default_value_width;
 
-    for (int i = 0; i < properties.size(); i++) {
-        item_inner_bounds.y = item_bounds.y + default_border_width + default_text_padding;
+    //----------------------------------------------
+    // Scrolling
+
+    Vector2 mouse_pos = GetMousePosition();
+    Rectangle scroll_bar_bounds = {
+        bounds.x + bounds.width - default_border_width - list_scrollbar_width,
+        bounds.y + default_border_width,
+        (float)list_scrollbar_width,
+        bounds.height - 2 * default_border_width
+    };
+
+    if (use_scroll_bar) {
+        // Value spinners already use the wheel, so only scroll over the names
+        Rectangle label_area = { bounds.x, bounds.y, default_value_x - bounds.x, bounds.height };
+        if (CheckCollisionPointRec(mouse_pos, label_area))
+            start_index -= (int)GetMouseWheelMove();
+
+        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mouse_pos, scroll_bar_bounds)) {
+            float progress = (mouse_pos.y - scroll_bar_bounds.y) / scroll_bar_bounds.height;
+            start_index = (int)std::round(progress * max_start_index);
+        }
+    }
+
+    start_index = std::clamp(start_index, 0, max_start_index);
+    if (scroll_index != nullptr)
+        *scroll_index = start_index;
+
+    //----------------------------------------------
+    // Visible rows
+
+    GuiGroupBox(bounds, NULL);
+
+    int used_lines = 0;
+    int clicked = -1;
+
+    for (int i = start_index; i < properties.size(); i++) {
         DebugProperty* property = &properties[i];
 
+        const int height = get_property_height(property);
+        used_lines += height;
+        if (used_lines > visible_lines)
+            break;
+
+        Rectangle label_bounds = { item_bounds.x, item_bounds.y, default_label_width, (float)line_height * height };
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mouse_pos, label_bounds))
+            clicked = i;
+
+        item_inner_bounds.y = item_bounds.y + default_border_width + default_text_padding;
+
         Rectangle default_value_bounds = {
             default_value_x,
             item_inner_bounds.y,
@@ -184,7 +256,130 @@ int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty> properties,
         item_bounds.y += list_items_height + list_items_spacing;
     }
 
-    return 0;
+    //----------------------------------------------
+    // Scroll bar
+
+    if (use_scroll_bar) {
+        float thumb_height = std::max(16.0f, scroll_bar_bounds.height * visible_lines / list_lines);
+        float thumb_y = scroll_bar_bounds.y + (scroll_bar_bounds.height - thumb_height) * start_index / max_start_index;
+
+        DrawRectangleRec(scroll_bar_bounds, GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_DISABLED)));
+        DrawRectangleRec(
+            { scroll_bar_bounds.x, thumb_y, scroll_bar_bounds.width, thumb_height },
+            GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_NORMAL)));
+    }
+
+    return clicked;
+}
+
+// Draws a list of levels with their thumbnail beside each name. Thumbnails are only asked for
+// the rows on screen. Clicking a level selects it, clicking it again deselects it.
+// Returns true if active changed
+bool GuiLevelListView(Rectangle bounds, const std::vector<LevelInfo>& levels, LevelThumbnails* thumbnails, int* scroll_index, int* active)
+{
+    const int list_items_spacing = GuiGetStyle(LISTVIEW, LIST_ITEMS_SPACING);
+    const int default_border_width = GuiGetStyle(DEFAULT, BORDER_WIDTH);
+    const int list_scrollbar_width = GuiGetStyle(LISTVIEW, SCROLLBAR_WIDTH);
+
+    const int row_height = LevelThumbnails::SIZE / 2 + 4;
+    const int line_height = row_height + list_items_spacing;
+    const int visible_lines = std::max(1, (int)(bounds.height - list_items_spacing - 2 * default_border_width) / line_height);
+
+    const int max_start_index = std::max(0, (int)levels.size() - visible_lines);
+    const bool use_scroll_bar = max_start_index > 0;
+
+    //----------------------------------------------
+    // Scrolling
+
+    Vector2 mouse_pos = GetMousePosition();
+    Rectangle scroll_bar_bounds = {
+        bounds.x + bounds.width - default_border_width - list_scrollbar_width,
+        bounds.y + default_border_width,
+        (float)list_scrollbar_width,
+        bounds.height - 2 * default_border_width
+    };
+
+    int start_index = *scroll_index;
+
+    if (use_scroll_bar) {
+        if (CheckCollisionPointRec(mouse_pos, bounds))
+            start_index -= (int)GetMouseWheelMove();
+
+        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(mouse_pos, scroll_bar_bounds)) {
+            float progress = (mouse_pos.y - scroll_bar_bounds.y) / scroll_bar_bounds.height;
+            start_index = (int)std::round(progress * max_start_index);
+        }
+    }
+
+    start_index = std::clamp(start_index, 0, max_start_index);
+    *scroll_index = start_index;
+
+    //----------------------------------------------
+    // Visible rows
+
+    GuiGroupBox(bounds, NULL);
+
+    Rectangle row_bounds = {
+        bounds.x + list_items_spacing + default_border_width,
+        bounds.y + list_items_spacing + default_border_width,
+        bounds.width - 2 * list_items_spacing - 2 * default_border_width,
+        (float)row_height
+    };
+
+    if (use_scroll_bar)
+        row_bounds.width -= list_scrollbar_width;
+
+    bool changed = false;
+    const int end_index = std::min((int)levels.size(), start_index + visible_lines);
+
+    for (int i = start_index; i < end_index; i++) {
+        bool hovered = CheckCollisionPointRec(mouse_pos, row_bounds) && !CheckCollisionPointRec(mouse_pos, scroll_bar_bounds);
+
+        if (hovered && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            *active = *active == i ? -1 : i;
+            changed = true;
+        }
+
+        if (*active == i)
+            DrawRectangleRec(row_bounds, GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_PRESSED)));
+        else if (hovered)
+            DrawRectangleRec(row_bounds, GetColor(GuiGetStyle(LISTVIEW, BASE_COLOR_FOCUSED)));
+
+        Rectangle thumbnail_bounds = { row_bounds.x + 2, row_bounds.y + 2, (float)row_height - 4, (float)row_height - 4 };
+        Texture2D* thumbnail = thumbnails->get(levels[i]);
+
+        if (thumbnail)
+            DrawTexturePro(
+                *thumbnail,
+                { 0, 0, (float)thumbnail->width, (float)thumbnail->height },
+                thumbnail_bounds,
+                { 0, 0 },
+                0.0f,
+                WHITE);
+        else
+            DrawRectangleLinesEx(thumbnail_bounds, 1, GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_NORMAL)));
+
+        GuiLabel(
+            { thumbnail_bounds.x + thumbnail_bounds.width + 6, row_bounds.y, row_bounds.width - row_height - 6, row_bounds.height },
+            levels[i].file_name.c_str());
+
+        row_bounds.y += line_height;
+    }
+
+    //----------------------------------------------
+    // Scroll bar
+
+    if (use_scroll_bar) {
+        float thumb_height = std::max(16.0f, scroll_bar_bounds.height * visible_lines / levels.size());
+        float thumb_y = scroll_bar_bounds.y + (scroll_bar_bounds.height - thumb_height) * start_index / max_start_index;
+
+        DrawRectangleRec(scroll_bar_bounds, GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_DISABLED)));
+        DrawRectangleRec(
+            { scroll_bar_bounds.x, thumb_y, scroll_bar_bounds.width, thumb_height },
+            GetColor(GuiGetStyle(LISTVIEW, BORDER_COLOR_NORMAL)));
+    }
+
+    return changed;
 }
 
 void DrawIntSpinner(Rectangle bounds, int* pointer, DebugProperty* properties)
@@ -241,3 +436,16 @@ void DrawFloatSpinner(Rectangle bounds, float* pointer, DebugProperty* propertie
 
     GuiStatusBar(bounds, std::to_string(*pointer).c_str());
 }
+
+// raygui only loads styles from memory inside its implementation, which lives in this file
+bool GuiLoadStyleFromPack(AssetPack* pack, const char* name)
+{
+    AssetView view;
+    std::vector<unsigned char> storage;
+
+    if (!pack->get(name, &view, &storage))
+        return false;
+
+    GuiLoadStyleFromMemory(view.data, view.size);
+    return true;
+}
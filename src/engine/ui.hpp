@@ -1,10 +1,13 @@
 #pragma once
 
 #include "debug.hpp"
+#include "level_catalog.hpp"
 #include "raygui.h"
 #include <vector>
 
-int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty> properties, int* scroll_index);
+int GuiPropertyListView(Rectangle bounds, std::vector<DebugProperty>& properties, int* scroll_index, int* total_lines);
+bool GuiLoadStyleFromPack(class AssetPack* pack, const char* name);
+bool GuiLevelListView(Rectangle bounds, const std::vector<LevelInfo>& levels, class LevelThumbnails* thumbnails, int* scroll_index, int* active);
 
 void DrawIntSpinner(Rectangle bounds, int* pointer, DebugProperty* properties);
 void DrawFloatSpinner(Rectangle bounds, float* pointer, DebugProperty* properties);
@@ -3,13 +3,19 @@
 #include "cereal/details/helpers.hpp"
 #include "raylib.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdarg>
 #include <cstring>
+#include <map>
 #include <string>
+#include <tuple>
+#include <unordered_set>
 
 #include "../game/player.hpp"
 #include "entity.hpp"
 
 #include "save.hpp"
+#include "ui.hpp"
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/portable_binary.hpp>
 #include <cereal/archives/xml.hpp>
@@ -25,85 +31,336 @@ World::World()
 
 World::~World()
 {
+    cancel_level_load();
     clear_all();
 }
 
 int World::run()
 {
-    InitWindow(800, 450, "celestelike");
+    startup.begin();
 
     SetTraceLogLevel(TraceLogLevel::LOG_ALL);
-    GuiLoadStyle("style_candy.rgs");
+    log_sink.start("celestelike.log");
+    startup.mark("log_sink");
+
+    InitWindow(800, 450, "celestelike");
+    FrameScheduler::check_raylib();
+    startup.mark("window");
+
+    // Shipped assets come from the pack, levels on disk still win over packed ones
+    assets.open("assets.pak");
+    startup.mark("asset_pack");
+
+    if (!GuiLoadStyleFromPack(&assets, "style_candy.rgs"))
+        TraceLog(LOG_WARNING, "No GUI style in the asset pack, using raygui's default");
+    startup.mark("gui_style");
 
     SetTargetFPS(physics_data.fps);
 
+    jobs.init();
+    save_worker.start();
+    sim_thread.start();
+    startup.mark("workers");
+
     init();
+    startup.mark("init");
 
     while (!WindowShouldClose()) {
+        // Input is sampled in update, straight after the scheduler lets the frame start
+        frame_scheduler.begin_frame(physics_data.fps);
         update();
 
-        physics_data.accumulator += GetFrameTime() * !physics_data.freeze_fixed_update;
+        float frame_time = FrameScheduler::is_pacing() ? frame_scheduler.get_frame_time() : GetFrameTime();
+        physics_data.accumulator += frame_time * !physics_data.freeze_fixed_update;
+
+        int ticks = (int)(physics_data.accumulator / physics_data.timestep);
+        if (ticks > MAX_TICKS_PER_FRAME) {
+            ticks = MAX_TICKS_PER_FRAME;
+            physics_data.accumulator = physics_data.timestep * ticks;
+        }
+
+        if (physics_data.pipelined) {
+            // Toggled on since last frame, there's nothing to draw yet
+            if (!render_snapshots[front_snapshot].valid)
+                capture_render_snapshot(&render_snapshots[front_snapshot]);
+
+            RenderSnapshot* back = &render_snapshots[1 - front_snapshot];
+            sim_thread.run([this, ticks, back]() {
+                step_fixed_update(ticks);
+                capture_render_snapshot(back);
+            });
+
+            render_pipelined();
+        }
+
+        else {
+            render_snapshots[front_snapshot].valid = false;
+
+            step_fixed_update(ticks);
+            render();
+        }
+
+        frame_scheduler.end_frame();
+
+        if (!startup.is_first_frame_done()) {
+            startup.first_frame();
 
-        if (physics_data.accumulator >= physics_data.timestep) {
-            fixed_update(physics_data.timestep);
-            physics_data.accumulator -= physics_data.timestep;
-            physics_data.elapsed += physics_data.timestep;
+            // Only the level menu needs the catalog, no reason to hold up the first frame for it
+            level_catalog.open(GetWorkingDirectory(), &assets);
+            startup.mark("level_catalog");
         }
 
-        render();
+        if (startup.is_done()) {
+            startup.report("startup-times.log");
+            if (exit_after_startup)
+                break;
+        }
     }
 
     TraceLog(TraceLogLevel::LOG_INFO, "Closing program");
+    sim_thread.stop();
+    cancel_level_load();
+    level_journal.close();
+    save_worker.stop();
+    level_catalog.close();
+    assets.close();
+    jobs.shutdown();
+    debug.unload();
     CloseWindow();
     return 0;
 }
 
 //====================================================================
 
+void World::add_actor(Actor* actor)
+{
+    if (is_deferred()) {
+        commands.record(WorldCommandType::AddActor, actor);
+        return;
+    }
+
+    actors.push_back(actor);
+    entity_generation += 1;
+}
+
+void World::add_solid(Solid* solid)
+{
+    if (is_deferred()) {
+        commands.record(WorldCommandType::AddSolid, solid);
+        return;
+    }
+
+    solids.push_back(solid);
+    solid_grid.insert(solid);
+    entity_generation += 1;
+}
+
+void World::move_entity(Entity* entity, Vector2 pos)
+{
+    if (is_deferred()) {
+        commands.record(WorldCommandType::Move, entity, pos);
+        return;
+    }
+
+    entity->pos = pos;
+    refresh_entity_bounds(entity);
+}
+
+// When deferred, the destroy is always recorded and true is returned.
+// Entities that turn out not to be in the world are left alone when applied
 bool World::destroy_actor(Actor* actor)
 {
-    auto it = std::find(actors.begin(), actors.end(), actor);
-    if (it != actors.end()) {
-        actors.erase(it);
+    if (is_deferred()) {
+        commands.record(WorldCommandType::DestroyActor, actor);
         return true;
     }
 
-    return false;
+    auto it = std::find(actors.begin(), actors.end(), actor);
+    if (it == actors.end())
+        return false;
+
+    actors.erase(it);
+    forget_entity(actor);
+    delete actor;
+    entity_generation += 1;
+    return true;
 }
 
 bool World::destroy_solid(Solid* solid)
 {
-    auto it = std::find(solids.begin(), solids.end(), solid);
-    if (it != solids.end()) {
-        solids.erase(it);
+    if (is_deferred()) {
+        commands.record(WorldCommandType::DestroySolid, solid);
         return true;
     }
 
-    return false;
+    auto it = std::find(solids.begin(), solids.end(), solid);
+    if (it == solids.end())
+        return false;
+
+    solids.erase(it);
+    solid_grid.remove(solid);
+    forget_entity(solid);
+    delete solid;
+    entity_generation += 1;
+    return true;
+}
+
+void World::begin_deferred()
+{
+    deferred_depth += 1;
+}
+
+void World::end_deferred()
+{
+    deferred_depth -= 1;
+    if (deferred_depth <= 0) {
+        deferred_depth = 0;
+        apply_commands();
+    }
+}
+
+// Remove every destroyed entity with a single pass over the vector
+template <class T>
+static void erase_destroyed(std::vector<T*>* entities, const std::unordered_set<Entity*>& destroyed)
+{
+    int kept = 0;
+    for (T* entity : *entities) {
+        if (destroyed.count(entity)) {
+            delete entity;
+            continue;
+        }
+        (*entities)[kept++] = entity;
+    }
+    entities->resize(kept);
+}
+
+// Commands are applied sorted by source, so the result doesn't depend on which thread got there first
+void World::apply_commands()
+{
+    if (commands.empty())
+        return;
+
+    commands.sort();
+    std::vector<WorldCommand>* list = commands.get_commands();
+
+    // Count additions first so each vector grows at most once
+    int added_actors = 0;
+    int added_solids = 0;
+
+    for (WorldCommand& command : *list) {
+        added_actors += command.type == WorldCommandType::AddActor;
+        added_solids += command.type == WorldCommandType::AddSolid;
+    }
+
+    actors.reserve(actors.size() + added_actors);
+    solids.reserve(solids.size() + added_solids);
+
+    std::unordered_set<Entity*> destroyed_actors;
+    std::unordered_set<Entity*> destroyed_solids;
+
+    for (WorldCommand& command : *list) {
+        switch (command.type) {
+        case WorldCommandType::AddActor:
+            actors.push_back(static_cast<Actor*>(command.entity));
+            break;
+        case WorldCommandType::AddSolid:
+            solids.push_back(static_cast<Solid*>(command.entity));
+            solid_grid.insert(static_cast<Solid*>(command.entity));
+            break;
+        case WorldCommandType::DestroyActor:
+            destroyed_actors.insert(command.entity);
+            break;
+        case WorldCommandType::DestroySolid:
+            destroyed_solids.insert(command.entity);
+            break;
+        case WorldCommandType::Move:
+            command.entity->pos = command.pos;
+            refresh_entity_bounds(command.entity);
+            break;
+        }
+    }
+
+    commands.clear();
+
+    if (added_actors + added_solids + destroyed_actors.size() + destroyed_solids.size() > 0)
+        entity_generation += 1;
+
+    if (!destroyed_actors.empty()) {
+        for (Entity* entity : destroyed_actors)
+            forget_entity(entity);
+
+        erase_destroyed(&actors, destroyed_actors);
+    }
+
+    if (!destroyed_solids.empty()) {
+        for (Entity* entity : destroyed_solids) {
+            solid_grid.remove(static_cast<Solid*>(entity));
+            forget_entity(entity);
+        }
+
+        erase_destroyed(&solids, destroyed_solids);
+    }
+}
+
+// Keep the broadphase in sync after a solid has been moved or resized
+void World::refresh_entity_bounds(Entity* entity)
+{
+    Solid* solid = dynamic_cast<Solid*>(entity);
+    if (solid && solid_grid.contains(solid))
+        solid_grid.update(solid);
+}
+
+// Drop any references the world holds to an entity that is about to be deleted
+void World::forget_entity(Entity* entity)
+{
+    if (player_character == entity)
+        player_character = nullptr;
+
+    if (camera.follow_target == entity)
+        camera.follow_target = nullptr;
+
+    debug.forget_entity(entity);
 }
 
 void World::clear_all()
 {
     TraceLog(TraceLogLevel::LOG_INFO, "Clearing World");
     for (auto entity : actors) {
+        forget_entity(entity);
         delete entity;
     }
     actors.clear();
 
     for (auto entity : solids) {
+        forget_entity(entity);
         delete entity;
     }
     solids.clear();
+    solid_grid.clear();
 
     player_character = nullptr;
+    entity_generation += 1;
 }
 
 void World::clear_level()
 {
     for (auto entity : solids) {
+        forget_entity(entity);
         delete entity;
     }
     solids.clear();
+    solid_grid.clear();
+    entity_generation += 1;
+}
+
+//====================================================================
+
+void World::log_format(int log, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    debug.add_message_v(log, format, args);
+    va_end(args);
 }
 
 //====================================================================
@@ -113,7 +370,7 @@ std::vector<Collision> World::check_collision(CollisionEntity* to_check)
 {
     std::vector<Collision> collisions;
 
-    for (Solid* solid : solids) {
+    for (CollisionEntity* solid : query_solids(get_bounds(to_check))) {
 
         std::optional<Collision> collision = intersect_aabb(solid, to_check);
 
@@ -131,7 +388,7 @@ std::vector<CollisionEntity*> World::check_overlap(CollisionEntity* to_check)
 {
     std::vector<CollisionEntity*> collisions;
 
-    for (Solid* solid : solids) {
+    for (CollisionEntity* solid : query_solids(get_bounds(to_check))) {
         if (overlap_aabb(solid, to_check)) {
             collisions.push_back(solid);
         }
@@ -140,66 +397,40 @@ std::vector<CollisionEntity*> World::check_overlap(CollisionEntity* to_check)
     return collisions;
 }
 
-//====================================================================
-
-std::vector<const char*> World::get_levels()
+// Broadphase candidates, may contain solids that don't actually touch the area
+std::vector<CollisionEntity*> World::query_solids(Rectangle area)
 {
-    std::vector<const char*> levels;
-
-    TraceLog(TraceLogLevel::LOG_INFO, "Retrieving levels:");
-
-    FilePathList files = LoadDirectoryFiles(GetWorkingDirectory());
-    for (int i = 0; i < files.count; i++) {
-        const char* file_path = files.paths[i];
-        const char* file_name = GetFileName(file_path);
-        // TraceLog(TraceLogLevel::LOG_INFO, file_path);
-        // TraceLog(TraceLogLevel::LOG_INFO, GetFileName(file_path));
-
-        const char* ptr = strstr(file_name, "level-");
-        if (file_name == ptr) {
-            levels.push_back(file_name);
-            TraceLog(TraceLogLevel::LOG_INFO, TextFormat("   %s", file_name));
-        }
-    }
-
-    return levels;
+    std::vector<CollisionEntity*> candidates;
+    solid_grid.query(area, &candidates);
+    return candidates;
 }
 
+//====================================================================
+
+// Only the snapshot is taken here, the file is written on the save worker.
+// The result shows up in the debug log once it's done
 bool World::save_level(const char* level_name)
 {
-    // JSON archive
     std::string file_name;
     file_name
         .append("level-")
         .append(level_name)
-        .append(".json");
-    std::ofstream file(file_name);
-    if (!file.is_open())
-        return false;
-    cereal::JSONOutputArchive archive(file);
-
-    // // Binary archive
-    // std::string file_name;
-    // file_name
-    //     .append("level-")
-    //     .append(level_name)
-    //     .append(".bin");
-    // std::ofstream file(file_name, std::ios::binary);
-    // cereal::PortableBinaryOutputArchive archive(file);
-
-    // // XML archive
-    // std::string file_name;
-    // file_name
-    //     .append("level-")
-    //     .append(level_name)
-    //     .append(".xml");
-    // std::ofstream file(file_name);
-    // cereal::XMLOutputArchive archive(file);
+        .append(".lvl");
 
     TraceLog(TraceLogLevel::LOG_INFO, TextFormat("Saving file: %s", file_name.c_str()));
 
-    SaveData data(this);
-    archive(data);
+    // Saving the journaled level is just a compaction that happens now
+    if (level_journal.is_open() && level_journal.get_level_file() == file_name) {
+        compact_level(false);
+        return true;
+    }
+
+    std::unique_ptr<SaveData> data = std::make_unique<SaveData>(this);
+
+    // Anything journaled for the file being replaced is stale
+    level_journal.open(file_name, true);
+    save_worker.queue(file_name, std::move(data), false);
+    watch_level(file_name);
     return true;
 }
 
@@ -207,37 +438,50 @@ bool World::load_level(const char* level_file_name)
 {
     TraceLog(TraceLogLevel::LOG_INFO, TextFormat("Loading level file: %s", level_file_name));
 
+    // Whatever the background load was doing is stale now
+    cancel_level_load();
+
     clear_all();
+    level_journal.close();
+
+    // The file or its journal might still be in the middle of being written
+    save_worker.wait();
 
-    // JSON archive
     std::string file_name(level_file_name);
-    // file_name
-    //     .append("level-")
-    //     .append(level_name)
-    //     .append(".json");
-    std::ifstream file(file_name);
-    if (!file.is_open()) {
-        TraceLog(TraceLogLevel::LOG_WARNING, TextFormat("Could not open level '%s'", level_file_name));
+
+    std::vector<Entity*> loaded;
+    if (!read_level_entities(file_name, &loaded))
         return false;
-    }
 
-    cereal::JSONInputArchive archive(file);
+    apply_level(file_name, &loaded);
+    startup.level_ready();
+    return true;
+}
 
+// Safe to call off the main thread, nothing here touches the world's entities
+bool World::read_level_entities(const std::string& file_name, std::vector<Entity*>* entities)
+{
     SaveData data;
-
-    try {
-        archive(data);
-    } catch (cereal::Exception val) {
-        TraceLog(TraceLogLevel::LOG_WARNING, TextFormat("Could not deserialise level '%s' - %s", level_file_name, val.what()));
+    if (!read_level(file_name, &data, &assets, &jobs))
         return false;
-    }
 
+    // Entities are built in parallel too, then sorted into the world in file order
+    entities->resize(data.entities.size());
+    jobs.parallel_for(entities->size(), LOAD_BATCH_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            (*entities)[i] = data.entities[i]->ToEntity().release();
+    });
+
+    return true;
+}
+
+void World::apply_level(const std::string& file_name, std::vector<Entity*>* entities)
+{
     int loaded_actors = 0;
     int loaded_solids = 0;
     int loaded_other = 0;
 
-    for (std::unique_ptr<RawEntity>& raw : data.entities) {
-        Entity* entity = raw->ToEntity().release();
+    for (Entity* entity : *entities) {
 
         Actor* actor = dynamic_cast<Actor*>(entity);
         if (actor) {
@@ -259,6 +503,7 @@ bool World::load_level(const char* level_file_name)
         loaded_other += 1;
         delete entity;
     }
+    entities->clear();
 
     for (Actor* actor : actors) {
         Player* player = dynamic_cast<Player*>(actor);
@@ -274,9 +519,578 @@ bool World::load_level(const char* level_file_name)
         TraceLogLevel::LOG_INFO,
         "    Loaded %d actors, %d solids and found %d other",
         loaded_actors, loaded_solids, loaded_other);
+
+    solid_grid.rebuild(solids);
+    entity_generation += 1;
+
+    replay_journal(file_name);
+    level_journal.open(file_name, false);
+    watch_level(file_name);
+
+    debug.on_level_changed();
+}
+
+void World::spawn_default_level()
+{
+    add_solid(new Solid({ 0, 100 }, 1000.0f, 25.0f)); // Floor
+
+    Player* player = new Player({ 0, -100.0f });
+    add_actor(player);
+    camera.follow_target = player;
+}
+
+//====================================================================
+// Background level load
+
+// Reads the first candidate that loads on a thread of its own, the world is only
+// touched once update picks the result up
+void World::load_level_async(const std::vector<std::string>& candidates)
+{
+    cancel_level_load();
+    level_journal.close();
+    save_worker.wait();
+
+    level_load.candidates = candidates;
+    level_load.file_name.clear();
+    level_load.success = false;
+    level_load.done = false;
+
+    level_load.thread = std::thread([this]() {
+        for (const std::string& candidate : level_load.candidates) {
+            TraceLog(LOG_INFO, "Loading level file in the background: %s", candidate.c_str());
+
+            if (read_level_entities(candidate, &level_load.entities)) {
+                level_load.file_name = candidate;
+                level_load.success = true;
+                break;
+            }
+        }
+
+        level_load.done.store(true, std::memory_order_release);
+    });
+}
+
+void World::update_level_load()
+{
+    if (!level_load.thread.joinable() || !level_load.done.load(std::memory_order_acquire))
+        return;
+
+    level_load.thread.join();
+
+    // Only the default spawn or an earlier level is here, the editor waits for loads to finish
+    clear_all();
+
+    if (level_load.success)
+        apply_level(level_load.file_name, &level_load.entities);
+    else
+        spawn_default_level();
+
+    startup.level_ready();
+}
+
+void World::cancel_level_load()
+{
+    if (!level_load.thread.joinable())
+        return;
+
+    level_load.thread.join();
+
+    for (Entity* entity : level_load.entities)
+        delete entity;
+    level_load.entities.clear();
+}
+
+void World::record_edit(const TileEdit& edit)
+{
+    level_journal.append(edit);
+}
+
+// Applies edits journaled since the level file was last written. Only the last edit
+// to each tile counts, and tiles already in the wanted state are left alone
+void World::replay_journal(const std::string& level_file)
+{
+    std::vector<TileEdit> edits;
+    if (!LevelJournal::read(level_file, &edits))
+        return;
+
+    std::map<std::tuple<int, int, int, int>, bool> latest;
+    for (const TileEdit& edit : edits)
+        latest[{ edit.x, edit.y, edit.half_width, edit.half_height }] = edit.added;
+
+    int added = 0;
+    int removed = 0;
+
+    for (auto& [key, is_added] : latest) {
+        auto [x, y, half_width, half_height] = key;
+        Rectangle area = { (float)x - half_width, (float)y - half_height, half_width * 2.0f, half_height * 2.0f };
+
+        bool found = false;
+        for (CollisionEntity* entity : query_solids(area)) {
+            Solid* solid = dynamic_cast<Solid*>(entity);
+            if (!solid || (int)solid->pos.x != x || (int)solid->pos.y != y
+                || solid->half_width != half_width || solid->half_height != half_height)
+                continue;
+
+            found = true;
+            if (!is_added) {
+                destroy_solid(solid);
+                removed += 1;
+            }
+        }
+
+        if (is_added && !found) {
+            add_solid(new Solid({ (float)x, (float)y }, half_width, half_height));
+            added += 1;
+        }
+    }
+
+    TraceLog(
+        TraceLogLevel::LOG_INFO,
+        "    Replayed level journal, %d solids added and %d removed",
+        added, removed);
+}
+
+void World::update_saves()
+{
+    save_results.clear();
+    save_worker.take_results(&save_results);
+
+    for (SaveResult& result : save_results) {
+        const char* type = result.is_autosave ? "Autosave" : "Save";
+
+        if (result.success) {
+            TraceLog(LOG_INFO, "%s of '%s' done in %.1fms", type, result.file_name.c_str(), result.seconds * 1000.0);
+            log_format(1, "%s done - %s", type, result.file_name.c_str());
+
+            level_catalog.mark_saved(result.file_name, std::move(result.info));
+
+            // Our own write, not something to hot reload
+            if (result.file_name == level_file)
+                level_file_time = result.written_time;
+        } else {
+            TraceLog(LOG_WARNING, "%s of '%s' failed", type, result.file_name.c_str());
+            log_format(1, "%s FAILED - %s", type, result.file_name.c_str());
+        }
+    }
+}
+
+//====================================================================
+// Snapshots
+//
+// magic, elapsed, accumulator, solid count, actor count, then every solid as a
+// SolidState and every actor as its kind, the size of its state and the state
+
+static const unsigned int SNAPSHOT_MAGIC = 0x504E5357; // "WSNP"
+
+struct SolidState {
+    Vector2 pos;
+    int half_width;
+    int half_height;
+};
+
+enum class SnapshotKind : unsigned char {
+    Actor,
+    Player,
+};
+
+static SnapshotKind get_snapshot_kind(Actor* actor)
+{
+    return dynamic_cast<Player*>(actor) ? SnapshotKind::Player : SnapshotKind::Actor;
+}
+
+void World::take_snapshot(WorldSnapshot* snapshot)
+{
+    snapshot->bytes.clear();
+    snapshot->entity_generation = entity_generation;
+    snapshot->level_file = level_file;
+
+    StateWriter writer(&snapshot->bytes);
+
+    unsigned int solid_count = solids.size();
+    unsigned int actor_count = actors.size();
+
+    writer(SNAPSHOT_MAGIC);
+    writer(physics_data.elapsed);
+    writer(physics_data.accumulator);
+    writer(solid_count);
+    writer(actor_count);
+
+    unsigned char* solid_data = writer.append(sizeof(SolidState) * solid_count);
+    for (unsigned int i = 0; i < solid_count; i++) {
+        Solid* solid = solids[i];
+        SolidState state = { solid->pos, solid->half_width, solid->half_height };
+        memcpy(solid_data + sizeof(SolidState) * i, &state, sizeof(SolidState));
+    }
+
+    for (Actor* actor : actors) {
+        writer(get_snapshot_kind(actor));
+
+        // Filled in once the state is written, the buffer may move until then
+        size_t size_offset = snapshot->bytes.size();
+        writer.append(sizeof(unsigned int));
+
+        actor->save_state(writer);
+
+        unsigned int size = snapshot->bytes.size() - size_offset - sizeof(unsigned int);
+        memcpy(snapshot->bytes.data() + size_offset, &size, sizeof(unsigned int));
+    }
+}
+
+// The whole snapshot is checked before anything is touched, a broken one leaves the world alone
+bool World::restore_snapshot(WorldSnapshot* snapshot)
+{
+    if (snapshot->is_empty() || is_deferred())
+        return false;
+
+    if (snapshot->level_file != level_file) {
+        TraceLog(
+            LOG_WARNING,
+            "World snapshot was taken in '%s', not restoring it into '%s'",
+            snapshot->level_file.c_str(), level_file.c_str());
+        return false;
+    }
+
+    StateReader reader(snapshot->bytes.data(), snapshot->bytes.size());
+
+    unsigned int magic = 0;
+    float elapsed = 0.0f;
+    float accumulator = 0.0f;
+    unsigned int solid_count = 0;
+    unsigned int actor_count = 0;
+
+    reader(magic);
+    reader(elapsed);
+    reader(accumulator);
+    reader(solid_count);
+    reader(actor_count);
+
+    const unsigned char* solid_data = reader.take(sizeof(SolidState) * solid_count);
+
+    std::vector<SnapshotRecord>& records = snapshot->records;
+    records.clear();
+
+    for (unsigned int i = 0; i < actor_count && !reader.has_failed(); i++) {
+        SnapshotRecord record;
+        reader(record.kind);
+        reader(record.size);
+        record.data = reader.take(record.size);
+
+        if (record.kind > (unsigned char)SnapshotKind::Player)
+            break;
+
+        records.push_back(record);
+    }
+
+    if (reader.has_failed() || !reader.is_done() || magic != SNAPSHOT_MAGIC || records.size() != actor_count) {
+        TraceLog(LOG_WARNING, "World snapshot is not valid");
+        return false;
+    }
+
+    bool in_place = snapshot->entity_generation == entity_generation
+        && solid_count == solids.size()
+        && actor_count == actors.size();
+
+    for (unsigned int i = 0; i < actor_count && in_place; i++)
+        in_place = records[i].kind == (unsigned char)get_snapshot_kind(actors[i]);
+
+    // Same entities, only state that actually changed is touched. Nothing is journaled
+    // here, this path is meant to run many times a second
+    if (in_place) {
+        physics_data.elapsed = elapsed;
+        physics_data.accumulator = accumulator;
+
+        for (unsigned int i = 0; i < solid_count; i++) {
+            SolidState state;
+            memcpy(&state, solid_data + sizeof(SolidState) * i, sizeof(SolidState));
+
+            Solid* solid = solids[i];
+            if (solid->pos.x == state.pos.x && solid->pos.y == state.pos.y
+                && solid->half_width == state.half_width && solid->half_height == state.half_height)
+                continue;
+
+            solid->pos = state.pos;
+            solid->half_width = state.half_width;
+            solid->half_height = state.half_height;
+            solid_grid.update(solid);
+        }
+
+        bool matched = true;
+        for (unsigned int i = 0; i < actor_count; i++) {
+            StateReader actor_reader(records[i].data, records[i].size);
+            actors[i]->load_state(actor_reader);
+            matched &= !actor_reader.has_failed() && actor_reader.is_done();
+        }
+
+        // Records come from the same actors in the same build, so this means a bug in a transfer_state
+        if (!matched) {
+            TraceLog(LOG_WARNING, "World snapshot didn't match the entities it was restored into");
+            return false;
+        }
+
+        return true;
+    }
+
+    // Entities were added or removed since, build them again. The new actors are
+    // made and loaded first, the world is only cleared once they all worked
+    std::vector<Actor*> new_actors;
+    new_actors.reserve(actor_count);
+
+    for (SnapshotRecord& record : records) {
+        Actor* actor = record.kind == (unsigned char)SnapshotKind::Player ? new Player({ 0, 0 }) : new Actor();
+        new_actors.push_back(actor);
+
+        StateReader actor_reader(record.data, record.size);
+        actor->load_state(actor_reader);
+
+        if (actor_reader.has_failed() || !actor_reader.is_done()) {
+            for (Actor* made : new_actors)
+                delete made;
+
+            TraceLog(LOG_WARNING, "World snapshot has an actor that couldn't be loaded");
+            return false;
+        }
+    }
+
+    // Only the difference is journaled, the level on disk follows the restore
+    std::map<std::tuple<int, int, int, int>, int> old_tiles;
+    for (Solid* solid : solids)
+        old_tiles[{ (int)solid->pos.x, (int)solid->pos.y, solid->half_width, solid->half_height }] += 1;
+
+    cancel_level_load();
+    clear_all();
+
+    physics_data.elapsed = elapsed;
+    physics_data.accumulator = accumulator;
+
+    solids.reserve(solid_count);
+    for (unsigned int i = 0; i < solid_count; i++) {
+        SolidState state;
+        memcpy(&state, solid_data + sizeof(SolidState) * i, sizeof(SolidState));
+        Solid* solid = new Solid(state.pos, state.half_width, state.half_height);
+        solids.push_back(solid);
+
+        auto it = old_tiles.find({ (int)solid->pos.x, (int)solid->pos.y, solid->half_width, solid->half_height });
+        if (it != old_tiles.end() && it->second > 0)
+            it->second -= 1;
+        else
+            record_edit(Debugger::to_tile_edit(solid, true));
+    }
+
+    for (auto& [key, count] : old_tiles) {
+        if (count > 0)
+            record_edit({ std::get<0>(key), std::get<1>(key), std::get<2>(key), std::get<3>(key), false });
+    }
+
+    actors = std::move(new_actors);
+    for (Actor* actor : actors) {
+        if (!player_character && dynamic_cast<Player*>(actor))
+            player_character = (Player*)actor;
+    }
+
+    if (player_character)
+        camera.set_follow_target(player_character, true);
+    else
+        camera.follow_target = nullptr;
+
+    solid_grid.rebuild(solids);
+    entity_generation += 1;
+
+    debug.on_level_changed();
+
+    // Restoring the same snapshot again can stay in place
+    snapshot->entity_generation = entity_generation;
+
     return true;
 }
 
+void World::quick_save()
+{
+    auto start = std::chrono::steady_clock::now();
+    take_snapshot(&quick_save_snapshot);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    log_format(1, "Quick save - %d bytes in %.0fus", (int)quick_save_snapshot.get_size(), time.count() * 1000000.0);
+}
+
+void World::quick_load()
+{
+    if (quick_save_snapshot.is_empty()) {
+        log_format(1, "Quick load - nothing saved yet");
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool success = restore_snapshot(&quick_save_snapshot);
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    if (success)
+        log_format(1, "Quick load done in %.0fus", time.count() * 1000000.0);
+    else
+        log_format(1, "Quick load FAILED");
+}
+
+//====================================================================
+// Hot reload
+
+static std::filesystem::file_time_type get_file_time(const std::string& file_name)
+{
+    std::error_code error;
+    return std::filesystem::last_write_time(file_name, error);
+}
+
+void World::watch_level(const std::string& file_name)
+{
+    level_file = file_name;
+    level_file_time = get_file_time(file_name);
+    is_level_reload_pending = false;
+
+    size_t slash = file_name.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? "." : file_name.substr(0, slash);
+    level_watch_name = slash == std::string::npos ? file_name : file_name.substr(slash + 1);
+
+    if (!level_watcher.watch(directory))
+        TraceLog(LOG_INFO, "Level hot reload unavailable for '%s'", file_name.c_str());
+}
+
+void World::update_hot_reload()
+{
+    if (!level_watcher.is_watching())
+        return;
+
+    level_changes.clear();
+    bool complete = level_watcher.poll(&level_changes);
+
+    if (!complete || std::find(level_changes.begin(), level_changes.end(), level_watch_name) != level_changes.end())
+        is_level_reload_pending = true;
+
+    if (!is_level_reload_pending)
+        return;
+
+    // Wait for our own writes to land and be reported, so they aren't mistaken for outside edits
+    if (!save_worker.is_idle())
+        return;
+
+    update_saves();
+    is_level_reload_pending = false;
+
+    if (!FileExists(level_file.c_str()))
+        return;
+
+    std::filesystem::file_time_type time = get_file_time(level_file);
+    if (time == level_file_time)
+        return;
+
+    level_file_time = time;
+    hot_reload_level();
+}
+
+// Brings the solids in line with the level file without a full load. Solids that are in both
+// stay put, the player, camera and every other actor are left alone. Edits that are still
+// only in the journal are applied again on top, the file doesn't have them yet
+void World::hot_reload_level()
+{
+    SaveData data;
+    if (!read_save_file(level_file, &data, &jobs))
+        return;
+
+    std::map<std::tuple<int, int, int, int>, std::vector<std::unique_ptr<Entity>>> wanted;
+
+    for (std::unique_ptr<RawEntity>& raw : data.entities) {
+        std::unique_ptr<Entity> entity = raw->ToEntity();
+
+        Solid* solid = dynamic_cast<Solid*>(entity.get());
+        if (!solid)
+            continue;
+
+        wanted[{ (int)solid->pos.x, (int)solid->pos.y, solid->half_width, solid->half_height }].push_back(std::move(entity));
+    }
+
+    int added = 0;
+    int removed = 0;
+
+    begin_deferred();
+
+    for (Solid* solid : solids) {
+        auto it = wanted.find({ (int)solid->pos.x, (int)solid->pos.y, solid->half_width, solid->half_height });
+
+        if (it != wanted.end() && !it->second.empty()) {
+            it->second.pop_back();
+            continue;
+        }
+
+        destroy_solid(solid);
+        removed += 1;
+    }
+
+    for (auto& [key, entities] : wanted) {
+        for (std::unique_ptr<Entity>& entity : entities) {
+            add_solid(static_cast<Solid*>(entity.release()));
+            added += 1;
+        }
+    }
+
+    end_deferred();
+
+    level_journal.flush();
+    replay_journal(level_file);
+    debug.on_level_changed();
+
+    TraceLog(LOG_INFO, "Hot reloaded '%s' - %d solids added, %d removed", level_file.c_str(), added, removed);
+    log_format(1, "Reloaded %s - %d added, %d removed", level_file.c_str(), added, removed);
+}
+
+//====================================================================
+
+void World::update_autosave()
+{
+    autosave_timer += GetFrameTime();
+    if (autosave_timer < AUTOSAVE_INTERVAL)
+        return;
+
+    autosave_timer = 0.0f;
+
+    if (!level_journal.is_open() || level_journal.get_edit_count() == 0)
+        return;
+
+    level_journal.flush();
+
+    // Only the snapshot is made here, the level is written on the compactor thread
+    if (level_journal.get_edit_count() >= AUTOSAVE_COMPACT_EDITS && !level_journal.is_compacting())
+        compact_level(true);
+}
+
+// Compactions write the chunked binary format, so a level still in legacy JSON moves to a
+// .lvl file the first time. The old file and its journal stay until the new one is written,
+// a restart before then still finds them
+void World::compact_level(bool is_autosave)
+{
+    std::unique_ptr<SaveData> data = std::make_unique<SaveData>(this);
+
+    if (!level_file.ends_with(".json")) {
+        level_journal.compact(std::move(data), &save_worker, is_autosave);
+        return;
+    }
+
+    std::string old_file = level_file;
+    std::string new_file = old_file.substr(0, old_file.size() - strlen(".json")) + ".lvl";
+
+    level_journal.open(new_file, true);
+    save_worker.queue(new_file, std::move(data), is_autosave, [old_file](bool success) {
+        if (!success)
+            return;
+
+        std::remove((old_file + ".journal.old").c_str());
+        std::remove((old_file + ".journal").c_str());
+        std::remove(old_file.c_str());
+    });
+    watch_level(new_file);
+
+    if (quick_save_snapshot.level_file == old_file)
+        quick_save_snapshot.level_file = new_file;
+
+    TraceLog(LOG_INFO, "Level '%s' moves to '%s'", old_file.c_str(), new_file.c_str());
+}
+
 //====================================================================
 
 void World::init()
@@ -285,18 +1099,26 @@ void World::init()
 
     camera.reset();
 
-    // Try load default level or spawn default
-    if (!load_level("level-default.json")) {
-        add_solid(new Solid({ 0, 100 }, 1000.0f, 25.0f)); // Floor
-
-        Player* player = new Player({ 0, -100.0f });
-        add_actor(player);
-        camera.follow_target = player;
-    }
+    // Default level or spawn default, the first frames go out while it loads
+    load_level_async({ "level-default.lvl", "level-default.json" });
 }
 
 void World::update()
 {
+    // Sampled once, everything this frame reads the same snapshot
+    input.update(GetTime());
+
+    // Before the deferred batch, a finished load puts its entities straight in
+    update_level_load();
+
+    // Same for quick load, it may have to rebuild the entities
+    if (input.get_snapshot().is_pressed(Action::QuickSave))
+        quick_save();
+    if (input.get_snapshot().is_pressed(Action::QuickLoad))
+        quick_load();
+
+    begin_deferred();
+
     for (Solid* solid : solids)
         solid->update(this);
 
@@ -306,15 +1128,66 @@ void World::update()
     camera.update(this);
 
     debug.update(this);
+
+    end_deferred();
+
+    update_saves();
+    update_autosave();
+    update_hot_reload();
+    level_catalog.update();
 }
 
 void World::fixed_update(float dt)
 {
+    // Spawns and destroys are held back until every entity is done,
+    // so the parallel and serial actor paths give the same result
+    begin_deferred();
+
     for (Solid* solid : solids)
         solid->fixed_update(this, dt);
 
-    for (Actor* actor : actors)
-        actor->fixed_update(this, dt);
+    // Actors only read solids and write to themselves while being stepped
+
+    if (physics_data.parallel_actors && actors.size() >= physics_data.parallel_min_actors)
+        update_actors_parallel(dt);
+
+    else {
+        for (int i = 0; i < actors.size(); i++) {
+            WorldCommands::set_source(i);
+            actors[i]->fixed_update(this, dt);
+        }
+        WorldCommands::set_source(-1);
+    }
+
+    end_deferred();
+
+    debug.fixed_update(this);
+}
+
+void World::step_fixed_update(int ticks)
+{
+    for (int i = 0; i < ticks; i++) {
+        // The tick ends where the time left in the accumulator begins
+        input.begin_tick(input.get_sample_time() - (physics_data.accumulator - physics_data.timestep));
+
+        fixed_update(physics_data.timestep);
+        physics_data.accumulator -= physics_data.timestep;
+        physics_data.elapsed += physics_data.timestep;
+    }
+}
+
+void World::update_actors_parallel(float dt)
+{
+    jobs.parallel_for(
+        actors.size(),
+        physics_data.parallel_batch_size,
+        [this, dt](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                WorldCommands::set_source(i);
+                actors[i]->fixed_update(this, dt);
+            }
+            WorldCommands::set_source(-1);
+        });
 }
 
 void World::render()
@@ -332,6 +1205,47 @@ void World::render()
     EndDrawing();
 }
 
+// Runs on the sim thread when pipelined, only reads the world
+void World::capture_render_snapshot(RenderSnapshot* snapshot)
+{
+    snapshot->clear();
+    snapshot->camera = camera.get_camera();
+    snapshot->clear_color = clear_color;
+
+    for (Solid* solid : solids)
+        solid->capture(snapshot);
+
+    for (Actor* actor : actors)
+        actor->capture(snapshot);
+
+    snapshot->valid = true;
+}
+
+// Draws the last tick while the sim thread works on the next one
+void World::render_pipelined()
+{
+    RenderSnapshot* snapshot = &render_snapshots[front_snapshot];
+
+    BeginDrawing();
+    ClearBackground(snapshot->clear_color);
+
+    BeginMode2D(snapshot->camera);
+    snapshot->draw();
+    EndMode2D();
+
+    // The debug overlay reads the live world, so the tick has to be done first
+    sim_thread.wait();
+    front_snapshot = 1 - front_snapshot;
+
+    BeginMode2D(camera.get_camera());
+    debug.render_2d(this);
+    EndMode2D();
+
+    debug.render(this);
+
+    EndDrawing();
+}
+
 void World::render_2d_inner()
 {
     for (Solid* solid : solids)
@@ -1,22 +1,54 @@
 #pragma once
 
+#include "asset_pack.hpp"
 #include "camera.hpp"
+#include "commands.hpp"
 #include "debug.hpp"
+#include "file_watcher.hpp"
+#include "frame_scheduler.hpp"
+#include "input.hpp"
+#include "jobs.hpp"
+#include "level_catalog.hpp"
+#include "level_journal.hpp"
+#include "log_sink.hpp"
 #include "physics.hpp"
+#include "render_snapshot.hpp"
+#include "save_worker.hpp"
+#include "sim_thread.hpp"
+#include "spatial.hpp"
+#include "startup_profiler.hpp"
+#include "world_snapshot.hpp"
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
 #include <vector>
 
 class World {
+private:
+    // Declared first so it outlives everything that might log while shutting down
+    LogSink log_sink;
+
 public:
     World();
     ~World();
     int run();
 
 public:
-    inline void add_actor(class Actor* actor) { actors.push_back(actor); }
-    inline void add_solid(class Solid* solid) { solids.push_back(solid); }
+    // The world owns its entities, destroyed entities are deleted.
+    // While deferred these only record a command and return straight away
+    void add_actor(class Actor* actor);
+    void add_solid(class Solid* solid);
+    void move_entity(class Entity* entity, Vector2 pos);
 
     bool destroy_actor(class Actor* actor);
     bool destroy_solid(class Solid* solid);
+
+    // Record changes until the matching end_deferred, then apply them in one batch
+    void begin_deferred();
+    void end_deferred();
+    inline bool is_deferred() { return deferred_depth > 0; }
+
     void clear_all();
     void clear_level();
 
@@ -26,15 +58,42 @@ public:
 
     std::vector<Collision> check_collision(class CollisionEntity* to_check);
     std::vector<CollisionEntity*> check_overlap(class CollisionEntity* to_check);
+    std::vector<CollisionEntity*> query_solids(Rectangle area);
+
+    // Call after changing a solid's position or size directly
+    void refresh_entity_bounds(class Entity* entity);
+
+    // Changes every time entities are added or removed
+    inline unsigned int get_entity_generation() { return entity_generation; }
 
     inline void log(const char* text, int log = 0) { debug.add_message(text, log); }
+    void log_format(int log, const char* format, ...);
 
     inline PhysicsData* get_physics_data() { return &physics_data; }
+    inline JobSystem* get_jobs() { return &jobs; }
+    inline Input* get_input() { return &input; }
+    inline FrameScheduler* get_frame_scheduler() { return &frame_scheduler; }
 
 public:
-    std::vector<const char*> get_levels();
+    inline LevelCatalog* get_level_catalog() { return &level_catalog; }
+    inline AssetPack* get_assets() { return &assets; }
     bool save_level(const char* level_name);
     bool load_level(const char* level_file_name);
+    inline bool is_level_loading() { return level_load.thread.joinable(); }
+
+    // Quit as soon as the first frame is up and the default level is in, for timing cold starts
+    inline void set_exit_after_startup(bool exit) { exit_after_startup = exit; }
+    inline StartupProfiler* get_startup_profiler() { return &startup; }
+
+    // Journal an editor change to the loaded level, saved for real by the next compaction
+    void record_edit(const TileEdit& edit);
+
+public:
+    // Copies all simulation state, the snapshot's memory is reused between calls
+    void take_snapshot(WorldSnapshot* snapshot);
+    // Overwrites state in place when the entities are still the ones the snapshot was
+    // taken from, rebuilds them otherwise. Not while deferred
+    bool restore_snapshot(WorldSnapshot* snapshot);
 
 public:
     Color clear_color;
@@ -44,18 +103,107 @@ protected:
     void init();
     void update();
     void fixed_update(float dt);
+    void step_fixed_update(int ticks);
     void render();
     void render_2d_inner();
 
+    void capture_render_snapshot(RenderSnapshot* snapshot);
+    void render_pipelined();
+
+    void update_actors_parallel(float dt);
+    void apply_commands();
+    void forget_entity(class Entity* entity);
+
+    bool read_level_entities(const std::string& file_name, std::vector<class Entity*>* entities);
+    void apply_level(const std::string& file_name, std::vector<class Entity*>* entities);
+    void spawn_default_level();
+
+    void load_level_async(const std::vector<std::string>& candidates);
+    void update_level_load();
+    void cancel_level_load();
+
+    void replay_journal(const std::string& level_file);
+    void compact_level(bool is_autosave);
+    void update_saves();
+    void update_autosave();
+
+    void quick_save();
+    void quick_load();
+
+    void watch_level(const std::string& file_name);
+    void update_hot_reload();
+    void hot_reload_level();
+
     friend class Game;
 
 private:
     std::vector<class Actor*> actors;
     std::vector<class Solid*> solids;
 
-    class Player* player_character;
+    class Player* player_character = nullptr;
+
+    SpatialGrid solid_grid;
+    unsigned int entity_generation = 0;
+
+    int deferred_depth = 0;
+    WorldCommands commands;
 
 private:
+    StartupProfiler startup;
+    bool exit_after_startup = false;
+
     PhysicsData physics_data;
+    FrameScheduler frame_scheduler;
+
+    // Backlog past this is dropped, catching up on it would keep input late for good
+    static const int MAX_TICKS_PER_FRAME = 4;
+    Input input;
+
+    // F6 to save, F7 to load
+    WorldSnapshot quick_save_snapshot;
+
+    // Pipelined mode - the sim thread fills the back snapshot while the front one is drawn
+    SimThread sim_thread;
+    RenderSnapshot render_snapshots[2];
+    int front_snapshot = 0;
+    AssetPack assets;
+    JobSystem jobs;
     Debugger debug;
+
+    // Entities created per job while loading
+    static const int LOAD_BATCH_SIZE = 1024;
+
+    // The default level is read on its own thread while the first frames are already up
+    struct LevelLoad {
+        std::thread thread;
+        std::atomic<bool> done = false;
+        std::vector<std::string> candidates;
+        std::string file_name;
+        std::vector<class Entity*> entities;
+        bool success = false;
+    };
+    LevelLoad level_load;
+
+    // Autosave - flush the journal every interval, compact it once it gets long
+    static constexpr float AUTOSAVE_INTERVAL = 5.0f;
+    static const int AUTOSAVE_COMPACT_EDITS = 2048;
+
+    LevelJournal level_journal;
+    float autosave_timer = 0.0f;
+
+    // Declared after the journal, queued compactions still call back into it
+    SaveWorker save_worker;
+    std::vector<SaveResult> save_results;
+
+    LevelCatalog level_catalog;
+
+    // Hot reload of the loaded level when it changes on disk
+    std::string level_file;
+    std::string level_watch_name;
+    // Full resolution, GetFileModTime only has seconds
+    std::filesystem::file_time_type level_file_time;
+    bool is_level_reload_pending = false;
+
+    FileWatcher level_watcher;
+    std::vector<std::string> level_changes;
 };
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//====================================================================
+// Binary snapshot of the simulation
+//
+// Everything is copied as raw bytes, field by field, so taking and restoring
+// one costs about as much as a memcpy of the state. Entities list their
+// fields once in a transfer_state template that works with both streams.
+// Snapshots only live in memory and are only read back by the same build.
+
+class StateWriter {
+public:
+    StateWriter(std::vector<unsigned char>* bytes)
+        : bytes(bytes)
+    {
+    }
+
+    template <class T>
+    inline void operator()(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "State fields are copied as raw bytes");
+
+        size_t offset = bytes->size();
+        bytes->resize(offset + sizeof(T));
+        memcpy(bytes->data() + offset, &value, sizeof(T));
+    }
+
+    template <class T>
+    inline void operator()(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "State fields are copied as raw bytes");
+
+        unsigned int count = values.size();
+        (*this)(count);
+
+        size_t offset = bytes->size();
+        bytes->resize(offset + sizeof(T) * count);
+        if (count > 0)
+            memcpy(bytes->data() + offset, values.data(), sizeof(T) * count);
+    }
+
+    // Room for size bytes to be filled in straight away, before anything else is written
+    inline unsigned char* append(size_t size)
+    {
+        size_t offset = bytes->size();
+        bytes->resize(offset + size);
+        return bytes->data() + offset;
+    }
+
+private:
+    std::vector<unsigned char>* bytes;
+};
+
+class StateReader {
+public:
+    StateReader(const unsigned char* data, size_t size)
+        : data(data)
+        , size(size)
+    {
+    }
+
+    // Reading past the end leaves the value alone and marks the reader failed
+    template <class T>
+    inline void operator()(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "State fields are copied as raw bytes");
+
+        if (failed || offset + sizeof(T) > size) {
+            failed = true;
+            return;
+        }
+
+        memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+    }
+
+    template <class T>
+    inline void operator()(std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "State fields are copied as raw bytes");
+
+        unsigned int count = 0;
+        (*this)(count);
+
+        if (failed || offset + sizeof(T) * count > size) {
+            failed = true;
+            return;
+        }
+
+        values.resize(count);
+        if (count > 0)
+            memcpy(values.data(), data + offset, sizeof(T) * count);
+        offset += sizeof(T) * count;
+    }
+
+    // The next size bytes, nullptr if there aren't that many left
+    inline const unsigned char* take(size_t count)
+    {
+        if (failed || offset + count > size) {
+            failed = true;
+            return nullptr;
+        }
+
+        const unsigned char* result = data + offset;
+        offset += count;
+        return result;
+    }
+
+    inline bool has_failed() { return failed; }
+    inline bool is_done() { return offset == size; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false;
+};
+
+//====================================================================
+
+// One actor's state inside a snapshot, found while checking it
+struct SnapshotRecord {
+    unsigned char kind = 0;
+    unsigned int size = 0;
+    const unsigned char* data = nullptr;
+};
+
+class WorldSnapshot {
+public:
+    inline bool is_empty() const { return bytes.empty(); }
+    inline size_t get_size() const { return bytes.size(); }
+
+private:
+    friend class World;
+
+    // Kept between snapshots, taking one again doesn't allocate
+    std::vector<unsigned char> bytes;
+    std::vector<SnapshotRecord> records;
+
+    // Entity generation of the world the layout matches. Restoring into that world
+    // only overwrites state, anything else rebuilds the entities
+    unsigned int entity_generation = 0;
+
+    // Level the snapshot was taken in. The journal and hot reload follow the
+    // level file, so it is only restored while that level is still loaded
+    std::string level_file;
+};
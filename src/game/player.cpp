@@ -2,6 +2,7 @@
 
 #include "../engine/tools.hpp"
 #include "../engine/world.hpp"
+#include "../engine/world_snapshot.hpp"
 #include "player_inner_characters.hpp"
 #include "raymath.h"
 #include <cmath>
@@ -14,10 +15,7 @@ Player::Player()
 {
     TraceLog(TraceLogLevel::LOG_INFO, "Creating player");
 
-    player_characters = { PlayerType::Base, PlayerType::Avian };
-    player_character_index = 0;
-
-    set_inner(player_characters[player_character_index]);
+    set_characters({ PlayerType::Base, PlayerType::Avian }, 0);
 }
 
 Player::Player(Vector2 new_pos)
@@ -28,24 +26,26 @@ Player::Player(Vector2 new_pos)
 
 // Doesn't call default constructor
 Player::Player(Vector2 new_pos, std::vector<PlayerType> characters, int index)
-    : player_characters(characters)
-    , player_character_index(index)
 {
     TraceLog(TraceLogLevel::LOG_INFO, "Creating player");
     pos = new_pos;
-    set_inner(characters[index]);
+    set_characters(characters, index);
 }
 
 //====================================================================
 
 void Player::update(World* world)
 {
-    player_input();
-    inner->update(world);
+    visit_inner([world](auto& inner) {
+        using Inner = std::decay_t<decltype(inner)>;
+        inner.Inner::update(world);
+    });
 }
 
 void Player::fixed_update(World* world, float dt)
 {
+    player_input(world);
+
     // Change character
     // Check if button pressed, not on cooldown and we have stuff to change to
     if (
@@ -53,24 +53,17 @@ void Player::fixed_update(World* world, float dt)
         && switch_character_cooldown <= 0.0f
         && player_characters.size() > 1 //
     ) {
-        player_character_index += 1;
-        player_character_index %= player_characters.size();
-
-        set_inner(player_characters[player_character_index]);
+        set_character((player_character_index + 1) % inners.size());
         switch_character_cooldown = switch_character_cooldown_size;
     }
 
     // Update inner
-    inner->fixed_update(world, dt);
+    visit_inner([world, dt](auto& inner) {
+        using Inner = std::decay_t<decltype(inner)>;
+        inner.Inner::fixed_update(world, dt);
+    });
     resolve_collisions(world, dt);
 
-    //----------------------------------------------
-    // Reset ability button pressed
-
-    ability_1_pressed = false;
-    ability_2_pressed = false;
-    ability_3_pressed = false;
-
     //----------------------------------------------
     // Update timers
 
@@ -95,60 +88,75 @@ void Player::fixed_update(World* world, float dt)
     }
 }
 
-void Player::set_inner(PlayerType inner_type)
+void Player::set_characters(const std::vector<PlayerType>& characters, int index)
 {
-    switch (inner_type) {
-    case PlayerType::Base:
-        inner = std::unique_ptr<PlayerInner>(new PlayerInner(this));
-        break;
-    case PlayerType::Debug:
-        inner = std::unique_ptr<PlayerInner>(new DebugPlayerInner(this));
-        break;
-    case PlayerType::Avian:
-        inner = std::unique_ptr<PlayerInner>(new AvianPlayerInner(this));
-        break;
-    case PlayerType::Celeste:
-        inner = std::unique_ptr<PlayerInner>(new CelestePlayerInner(this));
-        break;
-    };
+    player_characters = characters;
+    if (player_characters.empty())
+        player_characters = { PlayerType::Base };
+
+    inners.clear();
+    inners.reserve(player_characters.size());
+
+    for (PlayerType type : player_characters) {
+        switch (type) {
+        case PlayerType::Base:
+            inners.emplace_back(std::in_place_type<PlayerInner>, this);
+            break;
+        case PlayerType::Debug:
+            inners.emplace_back(std::in_place_type<DebugPlayerInner>, this);
+            break;
+        case PlayerType::Avian:
+            inners.emplace_back(std::in_place_type<AvianPlayerInner>, this);
+            break;
+        case PlayerType::Celeste:
+            inners.emplace_back(std::in_place_type<CelestePlayerInner>, this);
+            break;
+        };
+    }
+
+    set_character(index >= 0 && index < inners.size() ? index : 0);
 }
 
-void Player::player_input()
+void Player::set_character(int index)
 {
+    player_character_index = index;
+    get_inner()->enter();
+}
+
+void Player::player_input(World* world)
+{
+    // Input of this tick, presses are never dropped or seen twice
+    const InputSnapshot& input = world->get_input()->get_tick_snapshot();
+
     input_dir = { 0 };
 
     // Get movement directions
     // Left and right
-    if (are_keys_down(key_left))
+    if (input.is_down(Action::Left))
         input_dir.x -= 1.0f;
-    if (are_keys_down(key_right))
+    if (input.is_down(Action::Right))
         input_dir.x += 1.0f;
 
     // Up and down
-    if (are_keys_down(key_up))
+    if (input.is_down(Action::Up))
         input_dir.y -= 1.0f;
-    if (are_keys_down(key_down))
+    if (input.is_down(Action::Down))
         input_dir.y += 1.0f;
 
     // Start jump buffer
-    if (are_keys_pressed(key_jump)) {
+    if (input.is_pressed(Action::Jump)) {
         jump_pressed = true;
-        jump_buffer = inner->jump_buffer_size;
+        jump_buffer = get_inner()->jump_buffer_size;
     }
 
-    jump_held = are_keys_down(key_jump);
-
-    if (are_keys_pressed(key_ability_1))
-        ability_1_pressed = true;
-
-    if (are_keys_pressed(key_ability_2))
-        ability_2_pressed = true;
+    jump_held = input.is_down(Action::Jump);
 
-    if (are_keys_pressed(key_ability_3))
-        ability_3_pressed = true;
+    ability_1_pressed = input.is_pressed(Action::Ability1);
+    ability_2_pressed = input.is_pressed(Action::Ability2);
+    ability_3_pressed = input.is_pressed(Action::Ability3);
 
-    ability_1_down = are_keys_down(key_ability_1);
-    ability_2_down = are_keys_down(key_ability_2);
+    ability_1_down = input.is_down(Action::Ability1);
+    ability_2_down = input.is_down(Action::Ability2);
 }
 
 void Player::resolve_collisions(World* world, float dt)
@@ -241,6 +249,8 @@ void Player::resolve_collisions(World* world, float dt)
         }
     }
 
+    PlayerInner* inner = get_inner();
+
     if (grounded) {
         velocity.y = fmin(velocity.y, 0.0f); // TODO - move this functionality into inner
         remaining_jumps = inner->total_jumps;
@@ -262,7 +272,61 @@ void Player::resolve_collisions(World* world, float dt)
 
 void Player::render(World* world)
 {
-    inner->render(world);
+    visit_inner([world](auto& inner) {
+        using Inner = std::decay_t<decltype(inner)>;
+        inner.Inner::render(world);
+    });
+}
+
+void Player::capture(RenderSnapshot* snapshot)
+{
+    visit_inner([snapshot](auto& inner) {
+        using Inner = std::decay_t<decltype(inner)>;
+        inner.Inner::capture(snapshot);
+    });
+}
+
+//====================================================================
+
+// Every character's inner is saved, not just the active one, switching keeps their state
+void Player::save_state(StateWriter& writer)
+{
+    Actor::save_state(writer);
+
+    writer(player_characters);
+    writer(player_character_index);
+    transfer_state(writer);
+
+    for (PlayerInnerStorage& storage : inners) {
+        std::visit([&writer](auto& inner) { inner.transfer_state(writer); }, storage);
+    }
+}
+
+void Player::load_state(StateReader& reader)
+{
+    Actor::load_state(reader);
+
+    std::vector<PlayerType> characters;
+    int index = 0;
+    reader(characters);
+    reader(index);
+
+    if (reader.has_failed() || characters.empty() || index < 0 || index >= characters.size())
+        return;
+
+    // Only rebuilds the inners when the snapshot had other characters
+    if (characters != player_characters)
+        set_characters(characters, index);
+
+    player_character_index = index;
+    transfer_state(reader);
+
+    for (PlayerInnerStorage& storage : inners) {
+        std::visit([&reader](auto& inner) { inner.transfer_state(reader); }, storage);
+    }
+
+    // Rebuilding the inners may have reset the size
+    get_inner()->enter();
 }
 
 //====================================================================
@@ -278,7 +342,7 @@ void Player::get_properties(std::vector<DebugProperty>* properties)
 
     properties->push_back({ "velocity", &velocity, false });
 
-    inner->get_properties(properties);
+    get_inner()->get_properties(properties);
 }
 
 //====================================================================
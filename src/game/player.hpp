@@ -2,11 +2,18 @@
 #include "../engine/entity.hpp"
 #include "../engine/save.hpp"
 #include "player_inner_base.hpp"
+#include "player_inner_characters.hpp"
 #include "raylib.h"
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 //====================================================================
 
+// Every character's inner lives in place, switching characters doesn't allocate
+using PlayerInnerStorage = std::variant<PlayerInner, DebugPlayerInner, AvianPlayerInner, CelestePlayerInner>;
+
+
 class Player : public Actor, public IToRawData {
 public:
     friend class PlayerInner;
@@ -23,14 +30,61 @@ public:
     virtual void update(class World* world) override;
     virtual void fixed_update(class World* world, float dt) override;
     virtual void render(class World* world) override;
+    virtual void capture(class RenderSnapshot* snapshot) override;
+
+    virtual void save_state(class StateWriter& writer) override;
+    virtual void load_state(class StateReader& reader) override;
 
 private:
-    void set_inner(PlayerType inner_type);
-    void player_input();
+    // Builds an inner for every character up front, the only place inners are created
+    void set_characters(const std::vector<PlayerType>& characters, int index);
+    // Only changes which inner is active, tweaked values of the others are kept
+    void set_character(int index);
+
+    inline PlayerInner* get_inner()
+    {
+        return std::visit([](auto& inner) -> PlayerInner* { return &inner; }, inners[player_character_index]);
+    }
+
+    // Calls func with the active inner as its real type, so the call doesn't go through the vtable
+    template <class Func>
+    inline void visit_inner(Func&& func)
+    {
+        std::visit(func, inners[player_character_index]);
+    }
+
+    void player_input(World* world);
+
+    // Managed variables, for world snapshots
+    template <class Stream>
+    void transfer_state(Stream& stream)
+    {
+        stream(old_pos);
+        stream(input_dir);
+        stream(jump_held);
+        stream(jump_pressed);
+        stream(ability_1_pressed);
+        stream(ability_1_down);
+        stream(ability_2_pressed);
+        stream(ability_2_down);
+        stream(ability_3_pressed);
+        stream(velocity);
+        stream(grounded);
+        stream(on_ceiling);
+        stream(on_wall);
+        stream(time_since_grounded);
+        stream(jump_buffer);
+        stream(remaining_jumps);
+        stream(jumping);
+        stream(wall_jump_control_timer);
+        stream(switch_character_cooldown);
+        stream(switch_character_cooldown_size);
+    }
+
     void resolve_collisions(World* world, float dt);
 
 protected:
-    std::unique_ptr<class PlayerInner> inner;
+    std::vector<PlayerInnerStorage> inners;
     std::vector<PlayerType> player_characters = { PlayerType::Base, PlayerType::Avian };
     int player_character_index = 0;
 
@@ -66,16 +120,6 @@ protected:
 
 protected:
     // Config Player Variables
-    std::vector<int> key_up = { KEY_I };
-    std::vector<int> key_down = { KEY_K };
-    std::vector<int> key_left = { KEY_J };
-    std::vector<int> key_right = { KEY_L };
-
-    std::vector<int> key_jump = { KEY_SPACE };
-    std::vector<int> key_ability_1 = { KEY_C };
-    std::vector<int> key_ability_2 = { KEY_X };
-    std::vector<int> key_ability_3 = { KEY_Z };
-
     float switch_character_cooldown_size = 0.4f;
 
 public:
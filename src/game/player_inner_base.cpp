@@ -1,6 +1,7 @@
 #include "player_inner_base.hpp"
 
 #include "../engine/physics.hpp"
+#include "../engine/render_snapshot.hpp"
 #include "../engine/tools.hpp"
 #include "../engine/world.hpp"
 #include "player.hpp"
@@ -17,8 +18,8 @@ PlayerInner::PlayerInner(Player* outer)
 
     player_type = PlayerType::Base;
 
-    outer->half_width = 25;
-    outer->half_height = 32;
+    half_width = 25;
+    half_height = 32;
 
     player_color_1 = RED;
     player_color_2 = ORANGE;
@@ -45,6 +46,12 @@ PlayerInner::PlayerInner(Player* outer)
     update_jump_variables();
 }
 
+void PlayerInner::enter()
+{
+    outer->half_width = half_width;
+    outer->half_height = half_height;
+}
+
 void PlayerInner::update(World* world)
 {
 }
@@ -112,6 +119,13 @@ void PlayerInner::render(World* world)
         player_color_1, player_color_2, player_color_2, player_color_1);
 }
 
+void PlayerInner::capture(RenderSnapshot* snapshot)
+{
+    snapshot->add_gradient(
+        outer->get_rect(),
+        player_color_1, player_color_2, player_color_2, player_color_1);
+}
+
 bool PlayerInner::check_can_jump(World* world, float dt)
 {
     // Check if has all jumps
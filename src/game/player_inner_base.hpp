@@ -21,10 +21,14 @@ public:
 
     PlayerInner(class Player* outer);
 
+    // Becoming the active character, gives the player this character's size
+    void enter();
+
 protected:
     virtual void update(class World* world);
     virtual void fixed_update(class World* world, float dt);
     virtual void render(class World* world);
+    virtual void capture(class RenderSnapshot* snapshot);
 
     virtual void walk(class World* world, float dt);
     virtual bool check_can_jump(class World*, float dt);
@@ -45,10 +49,42 @@ protected:
 
     inline PlayerType get_player_type() { return player_type; }
 
+    // Every field but outer, for world snapshots. Characters add their own on top
+    template <class Stream>
+    void transfer_state(Stream& stream)
+    {
+        stream(half_width);
+        stream(half_height);
+        stream(accel);
+        stream(deaccel);
+        stream(max_velocity_x);
+        stream(max_fall_speed);
+        stream(jump_buffer_size);
+        stream(coyote_time);
+        stream(jump_height);
+        stream(jump_time_to_peak);
+        stream(jump_time_to_descent);
+        stream(variable_jump_height);
+        stream(total_jumps);
+        stream(wall_slide_gravity);
+        stream(wall_jump_impulse_x);
+        stream(wall_jump_control_timer_size);
+        stream(player_color_1);
+        stream(player_color_2);
+
+        stream(jump_impulse);
+        stream(jump_gravity);
+        stream(fall_gravity);
+        stream(variable_jump_gravity);
+    }
+
 protected:
     PlayerType player_type;
 
     // Config Player Variables
+    int half_width;
+    int half_height;
+
     float accel;
     float deaccel;
 
@@ -1,5 +1,6 @@
 #include "player_inner_characters.hpp"
 
+#include "../engine/render_snapshot.hpp"
 #include "player.hpp"
 #include "raymath.h"
 
@@ -8,8 +9,8 @@
 DebugPlayerInner::DebugPlayerInner(Player* outer)
     : PlayerInner(outer)
 {
-    outer->half_width = 0;
-    outer->half_height = 0;
+    half_width = 0;
+    half_height = 0;
 
     accel = 1000.0f;
 }
@@ -30,6 +31,11 @@ void DebugPlayerInner::render(World* world)
     DrawRectangle(outer->pos.x - 16, outer->pos.y - 16, 32, 32, BLUE);
 }
 
+void DebugPlayerInner::capture(RenderSnapshot* snapshot)
+{
+    snapshot->add_rect({ (float)(int)(outer->pos.x - 16), (float)(int)(outer->pos.y - 16), 32, 32 }, BLUE);
+}
+
 //====================================================================
 
 AvianPlayerInner::AvianPlayerInner(Player* outer)
@@ -37,8 +43,8 @@ AvianPlayerInner::AvianPlayerInner(Player* outer)
 {
     player_type = PlayerType::Avian;
 
-    outer->half_width = 20;
-    outer->half_height = 36;
+    half_width = 20;
+    half_height = 36;
 
     player_color_1 = GREEN;
 
@@ -3,26 +3,40 @@
 #include "player_inner_base.hpp"
 
 //====================================================================
+// Characters are final so calls on a known character type skip the vtable
 
-class DebugPlayerInner : public PlayerInner {
+class DebugPlayerInner final : public PlayerInner {
 public:
+    friend class Player;
+
     DebugPlayerInner(class Player* outer);
 
 protected:
     void fixed_update(World* world, float dt) override;
     void walk(World* world, float dt) override;
     void render(World* world) override;
+    void capture(RenderSnapshot* snapshot) override;
 };
 
 //====================================================================
 
-class AvianPlayerInner : public PlayerInner {
+class AvianPlayerInner final : public PlayerInner {
 public:
+    friend class Player;
+
     AvianPlayerInner(Player* outer);
 
 protected:
     void update(World* world) override;
 
+    template <class Stream>
+    void transfer_state(Stream& stream)
+    {
+        PlayerInner::transfer_state(stream);
+        stream(default_max_fall_speed);
+        stream(glide_max_fall_speed);
+    }
+
 protected:
     float default_max_fall_speed;
     float glide_max_fall_speed;
@@ -30,8 +44,10 @@ protected:
 
 //====================================================================
 
-class CelestePlayerInner : public PlayerInner {
+class CelestePlayerInner final : public PlayerInner {
 public:
+    friend class Player;
+
     CelestePlayerInner(Player* outer);
 
 protected:
@@ -42,6 +58,18 @@ protected:
     void fixed_update(class World* world, float dt) override;
     float get_gravity(class World* world) override;
 
+    template <class Stream>
+    void transfer_state(Stream& stream)
+    {
+        PlayerInner::transfer_state(stream);
+        stream(dash_cooldown);
+        stream(dash_cooldown_size);
+        stream(dashes);
+        stream(dashes_count);
+        stream(dash_power);
+        stream(default_max_velocity_x);
+    }
+
 protected:
     float dash_cooldown;
     float dash_cooldown_size;
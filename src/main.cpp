@@ -1,7 +1,30 @@
+#include "engine/load_bench.hpp"
 #include "engine/world.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-int main(void)
+int main(int argc, char** argv)
 {
+    // --bench-load [level file] [runs]
+    if (argc >= 2 && strcmp(argv[1], "--bench-load") == 0) {
+        const char* file_name = argc >= 3 ? argv[2] : nullptr;
+        int runs = argc >= 4 ? atoi(argv[3]) : 5;
+        return run_load_benchmark(file_name, runs);
+    }
+
     World world;
+
+    // --bench-startup quits once the default level is in, times go to startup-times.log
+    if (argc >= 2 && strcmp(argv[1], "--bench-startup") == 0) {
+        world.set_exit_after_startup(true);
+        int result = world.run();
+
+        StartupProfiler* startup = world.get_startup_profiler();
+        printf("First frame %.2fms, level ready %.2fms\n",
+            startup->get_first_frame_seconds() * 1000.0, startup->get_level_seconds() * 1000.0);
+        return result;
+    }
+
     world.run();
 }
@@ -0,0 +1,57 @@
+#include "../engine/asset_pack.hpp"
+#include "raylib.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// pack_tool <input directory>... <output pack> [--no-compress]
+// Packs every file directly inside the input directories, named by file name
+int main(int argc, char** argv)
+{
+    bool compress = !(argc >= 2 && strcmp(argv[argc - 1], "--no-compress") == 0);
+    int arg_count = compress ? argc : argc - 1;
+
+    if (arg_count < 3) {
+        printf("Usage: pack_tool <input directory>... <output pack> [--no-compress]\n");
+        return 1;
+    }
+
+    const char* output = argv[arg_count - 1];
+
+    std::vector<PackSource> sources;
+
+    for (int i = 1; i < arg_count - 1; i++) {
+        const char* input = argv[i];
+
+        FilePathList files = LoadDirectoryFiles(input);
+        for (unsigned int j = 0; j < files.count; j++) {
+            if (!IsPathFile(files.paths[j]))
+                continue;
+
+            sources.push_back({ GetFileName(files.paths[j]), files.paths[j] });
+        }
+        UnloadDirectoryFiles(files);
+
+        TraceLog(LOG_INFO, "Packing files from '%s'", input);
+    }
+
+    // Same pack for the same files, whatever order the directories list them in
+    std::sort(sources.begin(), sources.end(), [](const PackSource& a, const PackSource& b) { return a.name < b.name; });
+
+    // Entries are looked up by file name alone, two directories can't both have one
+    for (size_t i = 1; i < sources.size(); i++) {
+        if (sources[i].name == sources[i - 1].name) {
+            TraceLog(LOG_ERROR, "'%s' and '%s' would have the same name", sources[i - 1].path.c_str(), sources[i].path.c_str());
+            return 1;
+        }
+    }
+
+    TraceLog(LOG_INFO, "Packing %d files into '%s'", (int)sources.size(), output);
+
+    if (!write_asset_pack(output, sources, compress)) {
+        TraceLog(LOG_ERROR, "Could not write '%s'", output);
+        return 1;
+    }
+
+    return 0;
+}
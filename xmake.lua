@@ -1,6 +1,28 @@
 add_rules("mode.debug", "mode.release")
 
-add_requires("raylib", "raygui", "cereal", "magic_enum")
+-- Pace frames ourselves instead of SetTargetFPS, raylib has to be built with SUPPORT_CUSTOM_FRAME_CONTROL
+option("custom_frame_control")
+  set_default(false)
+  set_showmenu(true)
+  set_description("Frame scheduler sleeps and presents itself")
+  add_defines("CELESTE_CUSTOM_FRAME_CONTROL")
+option_end()
+
+if has_config("custom_frame_control") then
+  -- Otherwise EndDrawing still swaps, waits and polls input on top of the scheduler
+  add_requires("raylib", {configs = {cflags = "-DSUPPORT_CUSTOM_FRAME_CONTROL=1"}})
+else
+  add_requires("raylib")
+end
+add_requires("raygui", "cereal", "magic_enum")
+
+-- Packs src/resources and the shipped levels in src/levels into assets.pak
+target("pack_tool")
+  set_kind("binary")
+  add_files("src/tools/pack_tool.cpp")
+  add_files("src/engine/asset_pack.cpp")
+  add_packages("raylib")
+  set_languages("c++20")
 
 target("celestelike_raylib")
   set_kind("binary")
@@ -9,11 +31,20 @@ target("celestelike_raylib")
   add_files("src/game/*.cpp")
   add_packages("raylib", "raygui", "cereal", "magic_enum")
   set_languages("c++20")
-
-  set_configdir("$(buildir)/$(plat)/$(arch)/$(mode)")  
-  add_configfiles("src/resources/*", {onlycopy = true})
+  add_deps("pack_tool")
+  add_options("custom_frame_control")
 
   after_build(function(target)
+      -- Every resource ships in a single pack next to the binary, levels saved
+      -- into src/levels (level-default.lvl first of all) go in with them
+      local inputs = {path.join(os.projectdir(), "src/resources")}
+      local levels = path.join(os.projectdir(), "src/levels")
+      if os.isdir(levels) then
+          table.insert(inputs, levels)
+      end
+      table.insert(inputs, path.join(target:targetdir(), "assets.pak"))
+      os.execv(target:dep("pack_tool"):targetfile(), inputs)
+
       import("core.base.task")
       task.run("project", {kind = "compile_commands", outputdir = "./"})
   end)